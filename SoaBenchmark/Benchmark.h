@@ -0,0 +1,158 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Minimal timing harness. Each result is printed as one CSV line:
+// benchmark,variant,rows,columns,iterations,ns_per_iteration,ns_per_row
+namespace NBenchmark
+{
+	inline volatile std::uint64_t sink{};
+
+	struct Options
+	{
+		std::chrono::milliseconds min_time{ 200 };
+		std::size_t min_iterations{ 3 };
+	};
+
+	inline Options options;
+
+	inline void PrintHeader()
+	{
+		std::cout << "benchmark,variant,rows,columns,iterations,ns_per_iteration,ns_per_row\n";
+	}
+
+	// f() runs one iteration and returns a checksum so that the work cannot be optimized away.
+	// The median of all iterations is reported.
+	template <typename F>
+	void Run(std::string_view benchmark, std::string_view variant, std::size_t rows, std::size_t columns, F&& f)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		std::vector<double> samples;
+		auto const start{ Clock::now() };
+
+		sink = sink + f();	// Warm up
+
+		while (std::size(samples) < options.min_iterations || Clock::now() - start < options.min_time)
+		{
+			auto const begin{ Clock::now() };
+
+			sink = sink + f();
+			samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - begin).count());
+		}
+
+		std::ranges::nth_element(samples, std::begin(samples) + std::size(samples) / 2);
+
+		auto const median{ samples[std::size(samples) / 2] };
+
+		std::cout << benchmark << ',' << variant << ',' << rows << ',' << columns << ','
+			<< std::size(samples) << ',' << median << ',' << (rows == 0 ? 0.0 : median / rows) << '\n';
+	}
+
+	inline std::vector<std::uint32_t> RandomRows(std::size_t rows, std::size_t count)
+	{
+		std::mt19937 engine{ 42 };
+		std::uniform_int_distribution<std::uint32_t> distribution{ 0, static_cast<std::uint32_t>(rows - 1) };
+		std::vector<std::uint32_t> result(count);
+
+		for (auto& row : result)
+		{
+			row = distribution(engine);
+		}
+
+		return result;
+	}
+
+	// Runs the container suite for one row layout. Adapter provides:
+	//   using Container;
+	//   static constexpr std::size_t columns;
+	//   static void Append(Container&, std::int64_t i);					Builds row i and appends it
+	//   static std::int64_t SumRow(Container const&, std::size_t row);	Reads every column of one row
+	//   static std::int64_t SumColumn(Container const&);				Reads the first column of every row
+	template <typename Adapter>
+	void RunSuite(std::string_view variant, std::size_t rows)
+	{
+		using Container = typename Adapter::Container;
+
+		constexpr auto columns{ Adapter::columns };
+
+		auto const make{ [&](bool reserve) {
+			Container c;
+
+			if (reserve)
+			{
+				c.reserve(rows);
+			}
+
+			for (std::size_t i{}; i != rows; ++i)
+			{
+				Adapter::Append(c, static_cast<std::int64_t>(i));
+			}
+
+			return c;
+		} };
+
+		Run("construct", variant, rows, columns, [&] {
+			return static_cast<std::uint64_t>(std::size(make(true)));
+		});
+
+		Run("push_back", variant, rows, columns, [&] {
+			return static_cast<std::uint64_t>(std::size(make(false)));
+		});
+
+		// Note: Containers are copied and moved with parentheses. MetaStruct is constructible from anything,
+		// so braces would pick std::vector's initializer_list constructor.
+		Container c(make(true));
+
+		Run("get", variant, rows, columns, [&] {
+			std::int64_t sum{};
+
+			for (std::size_t i{}; i != rows; ++i)
+			{
+				sum += Adapter::SumRow(c, i);
+			}
+
+			return static_cast<std::uint64_t>(sum);
+		});
+
+		Run("column_scan", variant, rows, columns, [&] {
+			return static_cast<std::uint64_t>(Adapter::SumColumn(c));
+		});
+
+		auto const random_rows{ RandomRows(rows, rows) };
+
+		Run("random_access", variant, rows, columns, [&] {
+			std::int64_t sum{};
+
+			for (auto row : random_rows)
+			{
+				sum += Adapter::SumRow(c, row);
+			}
+
+			return static_cast<std::uint64_t>(sum);
+		});
+
+		Run("copy", variant, rows, columns, [&] {
+			Container copy(c);
+
+			return static_cast<std::uint64_t>(std::size(copy));
+		});
+
+		Run("move", variant, rows, columns, [&] {
+			Container moved(std::move(c));
+
+			c = std::move(moved);
+
+			return static_cast<std::uint64_t>(std::size(c));
+		});
+	}
+
+	void RunTaggedTupleBenchmarks(std::size_t rows);
+	void RunMetaStructBenchmarks(std::size_t rows);
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "Benchmark.h"
+#include "MetaStruct.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Note: MetaStruct.h declares FixedString, Member and Get at global scope,
+// so it is kept out of the translation unit that uses NDataStructure.
+namespace
+{
+	constexpr FixedString<2> column_names[]{ "c0", "c1", "c2", "c3", "c4", "c5", "c6", "c7" };
+
+	template <std::size_t... I>
+	auto MakeRow(std::index_sequence<I...>) -> MetaStruct<Member<column_names[I], std::int64_t>...>;
+
+	// MetaStruct<Member<"c0", std::int64_t>, ..., Member<"c{width - 1}", std::int64_t>>
+	template <std::size_t width>
+	using Row = decltype(MakeRow(std::make_index_sequence<width>{}));
+
+	template <std::size_t... I>
+	Row<sizeof...(I)> BuildRow(std::int64_t i, std::index_sequence<I...>)
+	{
+		return Row<sizeof...(I)>{ (arg<column_names[I]> = i + static_cast<std::int64_t>(I))... };
+	}
+
+	template <std::size_t... I, typename R>
+	std::int64_t SumAll(R const& row, std::index_sequence<I...>)
+	{
+		return (Get<column_names[I]>(row) + ...);
+	}
+
+	template <std::size_t width>
+	struct AosAdapter
+	{
+		using Container = std::vector<Row<width>>;
+
+		static constexpr std::size_t columns{ width };
+
+		static void Append(Container& c, std::int64_t i)
+		{
+			c.push_back(BuildRow(i, std::make_index_sequence<width>{}));
+		}
+
+		static std::int64_t SumRow(Container const& c, std::size_t row)
+		{
+			return SumAll(c[row], std::make_index_sequence<width>{});
+		}
+
+		static std::int64_t SumColumn(Container const& c)
+		{
+			std::int64_t sum{};
+
+			for (auto const& row : c)
+			{
+				sum += Get<"c0">(row);
+			}
+
+			return sum;
+		}
+	};
+}
+
+namespace NBenchmark
+{
+	void RunMetaStructBenchmarks(std::size_t rows)
+	{
+		RunSuite<AosAdapter<2>>("vector<MetaStruct>", rows);
+		RunSuite<AosAdapter<4>>("vector<MetaStruct>", rows);
+		RunSuite<AosAdapter<8>>("vector<MetaStruct>", rows);
+	}
+}
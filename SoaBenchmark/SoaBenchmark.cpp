@@ -0,0 +1,199 @@
+#include "Benchmark.h"
+#include "SoaVector.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NDataStructure;
+
+namespace
+{
+	using Account = TaggedTuple<
+		Member<"id", std::int64_t>,
+		Member<"type", int>,
+		Member<"score", double>,
+		Member<"last_login_time", std::int64_t>,
+		Member<"name", std::string>
+	>;
+
+	SoaVector<Account> MakeAccounts(std::size_t rows)
+	{
+		SoaVector<Account> v;
+
+		for (std::size_t i{}; i != rows; ++i)
+		{
+			v.push_back({
+				tag<"id"> = static_cast<std::int64_t>(i),
+				tag<"type"> = static_cast<int>(i % 7),
+				tag<"score"> = i * 0.25,
+				tag<"last_login_time"> = static_cast<std::int64_t>(1'600'000'000 + i),
+				tag<"name"> = "account" + std::to_string(i)
+			});
+		}
+
+		return v;
+	}
+
+	// Runs of 64 consecutive rows starting at random positions, as produced by a range-partitioned index.
+	std::vector<std::uint32_t> ClusteredRows(std::size_t rows, std::size_t count)
+	{
+		constexpr std::uint32_t run{ 64 };
+		auto starts{ NBenchmark::RandomRows(rows - run, (count + run - 1) / run) };
+		std::vector<std::uint32_t> result;
+
+		for (auto start : starts)
+		{
+			for (std::uint32_t i{}; i != run && std::size(result) != count; ++i)
+			{
+				result.push_back(start + i);
+			}
+		}
+
+		return result;
+	}
+
+	std::uint64_t Checksum(SoaVector<Account> const& v)
+	{
+		auto const ids{ Get<"id">(v) };
+
+		return std::size(v) + (std::empty(ids) ? 0 : static_cast<std::uint64_t>(ids.back()));
+	}
+
+	template <std::size_t prefetch_distance>
+	void GatherWithDistance(std::string_view pattern, SoaVector<Account> const& v, std::vector<std::uint32_t> const& rows)
+	{
+		NBenchmark::Run("gather", std::string{ pattern } + "/prefetch" + std::to_string(prefetch_distance), std::size(rows), Account::size(), [&] {
+			return Checksum(Gather<prefetch_distance>(v, rows));
+		});
+	}
+
+	void GatherBenchmark(std::size_t table_rows, std::size_t gathered_rows)
+	{
+		auto const v{ MakeAccounts(table_rows) };
+
+		for (auto const& [pattern, rows] : {
+			std::pair{ "random", NBenchmark::RandomRows(table_rows, gathered_rows) },
+			std::pair{ "clustered", ClusteredRows(table_rows, gathered_rows) } })
+		{
+			NBenchmark::Run("gather", std::string{ pattern } + "/operator[]", std::size(rows), Account::size(), [&] {
+				SoaVector<Account> result;
+
+				for (auto row : rows)
+				{
+					auto ref{ v[row] };
+
+					result.push_back({
+						tag<"id"> = Get<"id">(ref),
+						tag<"type"> = Get<"type">(ref),
+						tag<"score"> = Get<"score">(ref),
+						tag<"last_login_time"> = Get<"last_login_time">(ref),
+						tag<"name"> = Get<"name">(ref)
+					});
+				}
+
+				return Checksum(result);
+			});
+
+			GatherWithDistance<0>(pattern, v, rows);
+			GatherWithDistance<4>(pattern, v, rows);
+			GatherWithDistance<8>(pattern, v, rows);
+			GatherWithDistance<16>(pattern, v, rows);
+			GatherWithDistance<32>(pattern, v, rows);
+			GatherWithDistance<64>(pattern, v, rows);
+		}
+	}
+
+	// Handwritten equivalents of the generated rows, as the baseline for the tag machinery.
+	struct Plain2
+	{
+		std::int64_t c0, c1;
+
+		static Plain2 Make(std::int64_t i)
+		{
+			return { i + 0, i + 1 };
+		}
+
+		std::int64_t Sum() const
+		{
+			return c0 + c1;
+		}
+	};
+
+	struct Plain4
+	{
+		std::int64_t c0, c1, c2, c3;
+
+		static Plain4 Make(std::int64_t i)
+		{
+			return { i + 0, i + 1, i + 2, i + 3 };
+		}
+
+		std::int64_t Sum() const
+		{
+			return c0 + c1 + c2 + c3;
+		}
+	};
+
+	struct Plain8
+	{
+		std::int64_t c0, c1, c2, c3, c4, c5, c6, c7;
+
+		static Plain8 Make(std::int64_t i)
+		{
+			return { i + 0, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7 };
+		}
+
+		std::int64_t Sum() const
+		{
+			return c0 + c1 + c2 + c3 + c4 + c5 + c6 + c7;
+		}
+	};
+
+	template <typename Plain>
+	struct PlainAdapter
+	{
+		using Container = std::vector<Plain>;
+
+		static constexpr std::size_t columns{ sizeof(Plain) / sizeof(std::int64_t) };
+
+		static void Append(Container& c, std::int64_t i)
+		{
+			c.push_back(Plain::Make(i));
+		}
+
+		static std::int64_t SumRow(Container const& c, std::size_t row)
+		{
+			return c[row].Sum();
+		}
+
+		static std::int64_t SumColumn(Container const& c)
+		{
+			std::int64_t sum{};
+
+			for (auto const& row : c)
+			{
+				sum += row.c0;
+			}
+
+			return sum;
+		}
+	};
+}
+
+int main()
+{
+	NBenchmark::PrintHeader();
+
+	for (std::size_t rows : { 1 << 10, 1 << 16, 1 << 20 })
+	{
+		NBenchmark::RunSuite<PlainAdapter<Plain2>>("struct", rows);
+		NBenchmark::RunSuite<PlainAdapter<Plain4>>("struct", rows);
+		NBenchmark::RunSuite<PlainAdapter<Plain8>>("struct", rows);
+		NBenchmark::RunTaggedTupleBenchmarks(rows);
+		NBenchmark::RunMetaStructBenchmarks(rows);
+	}
+
+	GatherBenchmark(1 << 16, 1 << 14);
+	GatherBenchmark(1 << 22, 1 << 18);
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "Benchmark.h"
+#include "SoaVector.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace NDataStructure;
+
+namespace
+{
+	using InternalTaggedTuple::FixedString;
+
+	constexpr FixedString<2> column_names[]{ "c0", "c1", "c2", "c3", "c4", "c5", "c6", "c7" };
+
+	template <std::size_t... I>
+	auto MakeRow(std::index_sequence<I...>) -> TaggedTuple<Member<column_names[I], std::int64_t>...>;
+
+	// TaggedTuple<Member<"c0", std::int64_t>, ..., Member<"c{width - 1}", std::int64_t>>
+	template <std::size_t width>
+	using Row = decltype(MakeRow(std::make_index_sequence<width>{}));
+
+	template <std::size_t... I>
+	Row<sizeof...(I)> BuildRow(std::int64_t i, std::index_sequence<I...>)
+	{
+		return { (tag<column_names[I]> = i + static_cast<std::int64_t>(I))... };
+	}
+
+	template <std::size_t... I, typename R>
+	std::int64_t SumAll(R const& row, std::index_sequence<I...>)
+	{
+		return (Get<column_names[I]>(row) + ...);
+	}
+
+	template <std::size_t width>
+	struct AosAdapter
+	{
+		using Container = std::vector<Row<width>>;
+
+		static constexpr std::size_t columns{ width };
+
+		static void Append(Container& c, std::int64_t i)
+		{
+			c.push_back(BuildRow(i, std::make_index_sequence<width>{}));
+		}
+
+		static std::int64_t SumRow(Container const& c, std::size_t row)
+		{
+			return SumAll(c[row], std::make_index_sequence<width>{});
+		}
+
+		static std::int64_t SumColumn(Container const& c)
+		{
+			std::int64_t sum{};
+
+			for (auto const& row : c)
+			{
+				sum += Get<"c0">(row);
+			}
+
+			return sum;
+		}
+	};
+
+	template <std::size_t width>
+	struct SoaAdapter
+	{
+		using Container = SoaVector<Row<width>>;
+
+		static constexpr std::size_t columns{ width };
+
+		static void Append(Container& c, std::int64_t i)
+		{
+			c.push_back(BuildRow(i, std::make_index_sequence<width>{}));
+		}
+
+		static std::int64_t SumRow(Container const& c, std::size_t row)
+		{
+			return SumAll(c[row], std::make_index_sequence<width>{});
+		}
+
+		static std::int64_t SumColumn(Container const& c)
+		{
+			std::int64_t sum{};
+
+			for (auto value : Get<"c0">(c))
+			{
+				sum += value;
+			}
+
+			return sum;
+		}
+	};
+
+	template <std::size_t width>
+	void RunWidth(std::size_t rows)
+	{
+		NBenchmark::RunSuite<AosAdapter<width>>("vector<TaggedTuple>", rows);
+		NBenchmark::RunSuite<SoaAdapter<width>>("SoaVector", rows);
+	}
+}
+
+namespace NBenchmark
+{
+	void RunTaggedTupleBenchmarks(std::size_t rows)
+	{
+		RunWidth<2>(rows);
+		RunWidth<4>(rows);
+		RunWidth<8>(rows);
+	}
+}
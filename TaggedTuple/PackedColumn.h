@@ -0,0 +1,661 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SoaVector.h"
+
+namespace NDataStructure
+{
+	enum class PackedEncoding
+	{
+		FrameOfReference,	// value - block min, bit-packed. O(1) random access
+		Delta,				// first value + bit-packed (delta - block min delta). Best for sorted columns
+		Adaptive			// Per block, whichever of the two needs fewer bits
+	};
+
+	namespace InternalPackedColumn
+	{
+		template <typename T>
+		concept Packable = std::integral<T> && !std::same_as<T, bool>;
+
+		// Note: Bit width is a template parameter so that the shift/mask loop can be unrolled and vectorized.
+		template <unsigned bits>
+		void UnpackBits(std::uint64_t const* words, std::size_t n, std::uint64_t* out)
+		{
+			if constexpr (bits == 0)
+			{
+				std::fill_n(out, n, std::uint64_t{});
+			}
+			else
+			{
+				constexpr std::uint64_t mask{ bits == 64 ? ~std::uint64_t{} : (std::uint64_t{ 1 } << bits) - 1 };
+
+				for (std::size_t i{}; i != n; ++i)
+				{
+					auto const bit{ i * bits };
+					auto const word{ bit / 64 };
+					auto const offset{ bit % 64 };
+					auto value{ words[word] >> offset };
+
+					if (offset + bits > 64)
+					{
+						value |= words[word + 1] << (64 - offset);
+					}
+
+					out[i] = value & mask;
+				}
+			}
+		}
+
+		using UnpackFunction = void (*)(std::uint64_t const*, std::size_t, std::uint64_t*);
+
+		template <std::size_t... Bits>
+		constexpr auto MakeUnpackTable(std::index_sequence<Bits...>)
+		{
+			return std::array<UnpackFunction, sizeof...(Bits)>{ &UnpackBits<Bits>... };
+		}
+
+		inline constexpr auto unpack_table{ MakeUnpackTable(std::make_index_sequence<65>{}) };
+
+		inline void Unpack(unsigned bits, std::uint64_t const* words, std::size_t n, std::uint64_t* out)
+		{
+			unpack_table[bits](words, n, out);
+		}
+
+		inline void Pack(unsigned bits, std::span<std::uint64_t const> codes, std::vector<std::uint64_t>& words)
+		{
+			if (bits == 0)
+			{
+				return;
+			}
+
+			auto const first_word{ std::size(words) };
+
+			words.resize(first_word + (std::size(codes) * bits + 63) / 64);
+
+			auto out{ std::data(words) + first_word };
+
+			for (std::size_t i{}; i != std::size(codes); ++i)
+			{
+				auto const bit{ i * bits };
+				auto const word{ bit / 64 };
+				auto const offset{ bit % 64 };
+
+				out[word] |= codes[i] << offset;
+
+				if (offset + bits > 64)
+				{
+					out[word + 1] |= codes[i] >> (64 - offset);
+				}
+			}
+		}
+
+		// Note: Comparing T with Value converts both to their common type. Zone pruning and code-domain comparison
+		// are only valid if that conversion keeps the order of T, which it does not for a signed T against an unsigned type.
+		template <typename T, typename Value>
+		concept OrderPreserving = std::is_arithmetic_v<Value>
+			&& !(std::is_signed_v<T> && std::is_unsigned_v<std::common_type_t<T, Value>>);
+
+		// Note: Is value exactly some T, so that converting it to T leaves every comparison unchanged?
+		template <typename T, typename Value>
+		bool Representable(Value const& value)
+		{
+			if constexpr (std::is_floating_point_v<Value>)
+			{
+				auto const end{ std::ldexp(Value{ 1 }, std::numeric_limits<T>::digits) };
+				auto const begin{ std::is_signed_v<T> ? -end : Value{} };
+
+				return begin <= value && value < end && static_cast<Value>(static_cast<T>(value)) == value;
+			}
+			else
+			{
+				return std::in_range<T>(+value);
+			}
+		}
+
+		// Note: Does every value in [min, max] satisfy "value comparison"?
+		template <InternalTaggedTuple::TagComparison comparison, typename T, typename Value>
+		constexpr bool AllMatch(InternalSoaVector::Zone<T> const& zone, Value const& value)
+		{
+			using InternalTaggedTuple::TagComparison;
+
+			if constexpr (comparison == TagComparison::Equal)
+			{
+				return zone.min == zone.max && zone.min == value;
+			}
+			else if constexpr (comparison == TagComparison::NotEqual)
+			{
+				return value < zone.min || zone.max < value;
+			}
+			else
+			{
+				return InternalTaggedTuple::Compare<comparison>(zone.min, value) && InternalTaggedTuple::Compare<comparison>(zone.max, value);
+			}
+		}
+	}
+
+	// Immutable, block-wise compressed integer column.
+	template <typename T, std::size_t block_size = 128>
+		requires InternalPackedColumn::Packable<T>
+	class PackedColumn
+	{
+		using U = std::make_unsigned_t<T>;
+		using S = std::make_signed_t<T>;
+
+		struct Block
+		{
+			InternalSoaVector::Zone<T> zone;
+			T reference;	// FrameOfReference: min, Delta: first value
+			U delta_base;	// Delta: min delta
+			std::size_t word_offset;
+			std::uint8_t bits;
+			PackedEncoding encoding;
+		};
+
+		std::vector<Block> blocks;
+		std::vector<std::uint64_t> words;
+		std::size_t count{};
+
+	public:
+		using value_type = T;
+
+		PackedColumn() = default;
+
+		explicit PackedColumn(std::span<T const> values, PackedEncoding encoding = PackedEncoding::FrameOfReference)
+			: count{ std::size(values) }
+		{
+			blocks.reserve(BlockCount());
+
+			for (std::size_t begin{}; begin < count; begin += block_size)
+			{
+				AppendBlock(values.subspan(begin, std::min(block_size, count - begin)), encoding);
+			}
+
+			words.shrink_to_fit();
+		}
+
+		std::size_t size() const
+		{
+			return count;
+		}
+
+		bool empty() const
+		{
+			return count == 0;
+		}
+
+		std::size_t BlockCount() const
+		{
+			return (count + block_size - 1) / block_size;
+		}
+
+		std::size_t BlockLength(std::size_t block_index) const
+		{
+			return std::min(block_size, count - block_index * block_size);
+		}
+
+		InternalSoaVector::Zone<T> const& BlockZone(std::size_t block_index) const
+		{
+			return blocks[block_index].zone;
+		}
+
+		std::size_t MemoryUsage() const
+		{
+			return sizeof(*this) + blocks.capacity() * sizeof(Block) + words.capacity() * sizeof(std::uint64_t);
+		}
+
+		T operator[](std::size_t i) const
+		{
+			auto const& block{ blocks[i / block_size] };
+
+			if (block.encoding == PackedEncoding::FrameOfReference)
+			{
+				return FromCode(block.reference, CodeAt(block, i % block_size));
+			}
+
+			// Note: Delta needs every delta before the row, but not the ones after it.
+			auto const offset{ i % block_size };
+			std::array<std::uint64_t, block_size> codes;
+
+			InternalPackedColumn::Unpack(block.bits, std::data(words) + block.word_offset, offset, std::data(codes));
+
+			auto value{ static_cast<U>(block.reference) };
+
+			for (std::size_t j{}; j != offset; ++j)
+			{
+				value = static_cast<U>(value + static_cast<U>(block.delta_base + static_cast<U>(codes[j])));
+			}
+
+			return static_cast<T>(value);
+		}
+
+		// Note: out must hold at least BlockLength(block_index) values
+		void UnpackBlock(std::size_t block_index, std::span<T> out) const
+		{
+			auto const& block{ blocks[block_index] };
+			auto const n{ BlockLength(block_index) };
+			std::array<std::uint64_t, block_size> codes;
+
+			if (block.encoding == PackedEncoding::FrameOfReference)
+			{
+				InternalPackedColumn::Unpack(block.bits, std::data(words) + block.word_offset, n, std::data(codes));
+
+				for (std::size_t i{}; i != n; ++i)
+				{
+					out[i] = FromCode(block.reference, codes[i]);
+				}
+			}
+			else
+			{
+				InternalPackedColumn::Unpack(block.bits, std::data(words) + block.word_offset, n - 1, std::data(codes));
+
+				auto value{ static_cast<U>(block.reference) };
+
+				out[0] = block.reference;
+
+				for (std::size_t i{ 1 }; i != n; ++i)
+				{
+					value = static_cast<U>(value + static_cast<U>(block.delta_base + static_cast<U>(codes[i - 1])));
+					out[i] = static_cast<T>(value);
+				}
+			}
+		}
+
+		std::vector<T> Unpack() const
+		{
+			std::vector<T> values(count);
+
+			for (std::size_t block_index{}; block_index != std::size(blocks); ++block_index)
+			{
+				UnpackBlock(block_index, std::span{ values }.subspan(block_index * block_size));
+			}
+
+			return values;
+		}
+
+		// Clears the bits of mask whose rows in block_index do not satisfy "row comparison value", comparing exactly as
+		// SoaVector::Filter does (in the common type of T and Value).
+		// Note: Frame-of-reference blocks are compared in the packed code domain without reconstructing values
+		// when value is exactly representable as T.
+		template <InternalTaggedTuple::TagComparison comparison, typename Value>
+			requires std::is_arithmetic_v<Value>
+		void Match(std::size_t block_index, Value const& value, std::bitset<block_size>& mask) const
+		{
+			if constexpr (InternalPackedColumn::OrderPreserving<T, Value>)
+			{
+				MatchPacked<comparison>(block_index, value, mask);
+			}
+			else
+			{
+				MatchUnpacked<comparison>(block_index, value, mask);
+			}
+		}
+
+	private:
+		template <InternalTaggedTuple::TagComparison comparison, typename Value>
+		void MatchPacked(std::size_t block_index, Value const& value, std::bitset<block_size>& mask) const
+		{
+			auto const& block{ blocks[block_index] };
+			auto const n{ BlockLength(block_index) };
+
+			if (!InternalSoaVector::MayMatch<comparison>(block.zone, value))
+			{
+				mask.reset();
+
+				return;
+			}
+
+			if (InternalPackedColumn::AllMatch<comparison>(block.zone, value))
+			{
+				return;
+			}
+
+			if (block.encoding == PackedEncoding::FrameOfReference && InternalPackedColumn::Representable<T>(value))
+			{
+				// Note: value lies in [min, max] here, so (value - min) keeps the order of the codes
+				auto const code{ static_cast<std::uint64_t>(static_cast<U>(static_cast<U>(static_cast<T>(value)) - static_cast<U>(block.reference))) };
+				std::array<std::uint64_t, block_size> codes;
+
+				InternalPackedColumn::Unpack(block.bits, std::data(words) + block.word_offset, n, std::data(codes));
+
+				for (std::size_t i{}; i != n; ++i)
+				{
+					if (!InternalTaggedTuple::Compare<comparison>(codes[i], code))
+					{
+						mask.reset(i);
+					}
+				}
+			}
+			else
+			{
+				MatchUnpacked<comparison>(block_index, value, mask);
+			}
+		}
+
+		template <InternalTaggedTuple::TagComparison comparison, typename Value>
+		void MatchUnpacked(std::size_t block_index, Value const& value, std::bitset<block_size>& mask) const
+		{
+			auto const n{ BlockLength(block_index) };
+			std::array<T, block_size> values;
+
+			UnpackBlock(block_index, values);
+
+			for (std::size_t i{}; i != n; ++i)
+			{
+				if (!InternalTaggedTuple::Compare<comparison>(values[i], value))
+				{
+					mask.reset(i);
+				}
+			}
+		}
+
+		std::uint64_t CodeAt(Block const& block, std::size_t j) const
+		{
+			if (block.bits == 0)
+			{
+				return 0;
+			}
+
+			auto const bit{ j * block.bits };
+			auto const word{ std::data(words) + block.word_offset + bit / 64 };
+			auto const offset{ bit % 64 };
+			auto value{ word[0] >> offset };
+
+			if (offset + block.bits > 64)
+			{
+				value |= word[1] << (64 - offset);
+			}
+
+			return block.bits == 64 ? value : value & ((std::uint64_t{ 1 } << block.bits) - 1);
+		}
+
+		static T FromCode(T reference, std::uint64_t code)
+		{
+			return static_cast<T>(static_cast<U>(static_cast<U>(reference) + static_cast<U>(code)));
+		}
+
+		static unsigned BitWidth(U range)
+		{
+			return static_cast<unsigned>(std::bit_width(static_cast<std::uint64_t>(range)));
+		}
+
+		void AppendBlock(std::span<T const> values, PackedEncoding encoding)
+		{
+			auto const [min, max]{ std::ranges::minmax(values) };
+			auto const n{ std::size(values) };
+			Block block{ { min, max }, min, U{}, std::size(words), static_cast<std::uint8_t>(BitWidth(static_cast<U>(static_cast<U>(max) - static_cast<U>(min)))), PackedEncoding::FrameOfReference };
+			std::array<std::uint64_t, block_size> codes;
+
+			if (encoding != PackedEncoding::FrameOfReference && n > 1)
+			{
+				auto delta{ [&](std::size_t i) {
+					return static_cast<S>(static_cast<U>(static_cast<U>(values[i]) - static_cast<U>(values[i - 1])));
+				} };
+				auto min_delta{ delta(1) };
+				auto max_delta{ min_delta };
+
+				for (std::size_t i{ 2 }; i != n; ++i)
+				{
+					min_delta = std::min(min_delta, delta(i));
+					max_delta = std::max(max_delta, delta(i));
+				}
+
+				auto const delta_bits{ BitWidth(static_cast<U>(static_cast<U>(max_delta) - static_cast<U>(min_delta))) };
+
+				if (encoding == PackedEncoding::Delta || delta_bits < block.bits)
+				{
+					block.reference = values[0];
+					block.delta_base = static_cast<U>(min_delta);
+					block.bits = static_cast<std::uint8_t>(delta_bits);
+					block.encoding = PackedEncoding::Delta;
+
+					for (std::size_t i{ 1 }; i != n; ++i)
+					{
+						codes[i - 1] = static_cast<U>(static_cast<U>(delta(i)) - block.delta_base);
+					}
+
+					InternalPackedColumn::Pack(block.bits, std::span{ codes }.first(n - 1), words);
+					blocks.push_back(block);
+
+					return;
+				}
+			}
+
+			for (std::size_t i{}; i != n; ++i)
+			{
+				codes[i] = static_cast<U>(static_cast<U>(values[i]) - static_cast<U>(min));
+			}
+
+			InternalPackedColumn::Pack(block.bits, std::span{ codes }.first(n), words);
+			blocks.push_back(block);
+		}
+	};
+
+	namespace InternalPackedColumn
+	{
+		template <typename T, std::size_t block_size>
+		struct SealedColumn
+		{
+			using type = std::vector<T>;
+		};
+
+		template <Packable T, std::size_t block_size>
+		struct SealedColumn<T, block_size>
+		{
+			using type = PackedColumn<T, block_size>;
+		};
+
+		template <typename T, std::size_t block_size>
+		using SealedColumn_t = typename SealedColumn<T, block_size>::type;
+	}
+
+	// Immutable SoaVector whose integer columns are stored as PackedColumn.
+	template <typename TT, std::size_t block_size = 128>
+	class SealedSoaVector;
+
+	template <auto... Tags, typename... Ts, auto... Inits, std::size_t block_size>
+	class SealedSoaVector<TaggedTuple<Member<Tags, Ts, Inits>...>, block_size>
+	{
+		using TT = TaggedTuple<Member<Tags, Ts, Inits>...>;
+		using Mask = std::bitset<block_size>;
+
+		TaggedTuple<Member<Tags, InternalPackedColumn::SealedColumn_t<TaggedTupleValueType_t<Tags, TT>, block_size>>...> columns;
+		std::size_t count{};
+
+	public:
+		SealedSoaVector() = default;
+
+		template <std::size_t N>
+		explicit SealedSoaVector(SoaVector<TT, N> soa, PackedEncoding encoding = PackedEncoding::FrameOfReference)
+			: count{ std::size(soa) }
+		{
+			((Get<Tags>(columns) = MakeColumn(std::move(Get<Tags>(soa.Vectors())), encoding)), ...);
+		}
+
+		decltype(auto) Columns() const
+		{
+			return (columns);
+		}
+
+		std::size_t size() const
+		{
+			return count;
+		}
+
+		bool empty() const
+		{
+			return count == 0;
+		}
+
+		std::size_t MemoryUsage() const
+		{
+			auto usage{ sizeof(*this) };
+
+			columns.ForEach([&](auto const& m) {
+				if constexpr (requires { m.Value().MemoryUsage(); })
+				{
+					usage += m.Value().MemoryUsage();
+				}
+				else
+				{
+					usage += m.Value().capacity() * sizeof(typename std::remove_cvref_t<decltype(m.Value())>::value_type);
+				}
+			});
+
+			return usage;
+		}
+
+		TT operator[](std::size_t i) const
+		{
+			return TT{ (tag<Tags> = TaggedTupleValueType_t<Tags, TT>(Get<Tags>(columns)[i]))... };
+		}
+
+		SoaVector<TT> Unseal() const
+		{
+			SoaVector<TT> soa;
+
+			((Get<Tags>(soa.Vectors()) = ColumnVector<Tags>()), ...);
+
+			return soa;
+		}
+
+		// Same contract as SoaVector::Filter(); packed columns are matched block-wise on compressed data.
+		template <typename... Predicates>
+		std::vector<std::size_t> Filter(Predicates const&... predicates) const
+		{
+			std::vector<std::size_t> result;
+
+			for (std::size_t begin{}; begin < count; begin += block_size)
+			{
+				auto const n{ std::min(block_size, count - begin) };
+				auto mask{ ~Mask{} >> (block_size - n) };
+
+				((mask.any() ? MatchBlock(begin, n, predicates, mask) : void()), ...);
+
+				for (std::size_t i{}; mask.any() && i != n; ++i)
+				{
+					if (mask[i])
+					{
+						result.push_back(begin + i);
+					}
+				}
+			}
+
+			return result;
+		}
+
+	private:
+		template <typename T>
+		static auto MakeColumn(std::vector<T>&& values, PackedEncoding encoding)
+		{
+			if constexpr (InternalPackedColumn::Packable<T>)
+			{
+				return PackedColumn<T, block_size>{ std::span<T const>{ values }, encoding };
+			}
+			else
+			{
+				return std::move(values);
+			}
+		}
+
+		template <auto Tag>
+		auto ColumnVector() const
+		{
+			auto const& column{ Get<Tag>(columns) };
+
+			if constexpr (requires { column.Unpack(); })
+			{
+				return column.Unpack();
+			}
+			else
+			{
+				return column;
+			}
+		}
+
+		template <typename TagOrValue1, typename TagOrValue2, InternalTaggedTuple::TagComparison comparison>
+		void MatchBlock(std::size_t begin, std::size_t n, InternalTaggedTuple::TagComparatorPredicate<TagOrValue1, TagOrValue2, comparison> const& predicate, Mask& mask) const
+		{
+			using InternalTaggedTuple::is_tuple_tag_v;
+
+			if constexpr (is_tuple_tag_v<TagOrValue1> && !is_tuple_tag_v<TagOrValue2>)
+			{
+				MatchColumn<TagOrValue1, comparison>(begin, n, predicate.tag_or_value2, mask);
+			}
+			else if constexpr (!is_tuple_tag_v<TagOrValue1> && is_tuple_tag_v<TagOrValue2>)
+			{
+				MatchColumn<TagOrValue2, InternalTaggedTuple::Mirror(comparison)>(begin, n, predicate.tag_or_value1, mask);
+			}
+			else
+			{
+				// Note: Both sides are columns; each is unpacked once per block rather than once per row.
+				auto const values1{ BlockValues<TagOrValue1>(begin, n) };
+				auto const values2{ BlockValues<TagOrValue2>(begin, n) };
+
+				for (std::size_t i{}; i != n; ++i)
+				{
+					if (mask[i] && !InternalTaggedTuple::Compare<comparison>(values1[i], values2[i]))
+					{
+						mask.reset(i);
+					}
+				}
+			}
+		}
+
+		// Rows [begin, begin + n) of Tag's column: a stack copy for packed columns, a view otherwise.
+		template <typename Tag>
+		auto BlockValues(std::size_t begin, std::size_t n) const
+		{
+			auto const& column{ Get<Tag::value>(columns) };
+
+			if constexpr (requires { column.Unpack(); })
+			{
+				std::array<typename std::remove_cvref_t<decltype(column)>::value_type, block_size> values;
+
+				column.UnpackBlock(begin / block_size, values);
+
+				return values;
+			}
+			else
+			{
+				return std::span{ column }.subspan(begin, n);
+			}
+		}
+
+		template <typename Tag, InternalTaggedTuple::TagComparison comparison, typename Value>
+		void MatchColumn(std::size_t begin, std::size_t n, Value const& value, Mask& mask) const
+		{
+			auto const& column{ Get<Tag::value>(columns) };
+
+			if constexpr (requires { column.template Match<comparison>(begin / block_size, value, mask); })
+			{
+				column.template Match<comparison>(begin / block_size, value, mask);
+			}
+			else
+			{
+				for (std::size_t i{}; i != n; ++i)
+				{
+					if (!InternalTaggedTuple::Compare<comparison>(column[begin + i], value))
+					{
+						mask.reset(i);
+					}
+				}
+			}
+		}
+	};
+
+	template <typename Tag, typename TT, std::size_t N>
+	decltype(auto) GetImpl(SealedSoaVector<TT, N> const& s)
+	{
+		return Get<Tag::value>(s.Columns());
+	}
+}
\ No newline at end of file
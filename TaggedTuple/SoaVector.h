@@ -1,26 +1,217 @@
 #pragma once
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <ranges>
 #include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include "TaggedTuple.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
 namespace NDataStructure
 {
-	template <typename TT>
+	namespace InternalSoaVector
+	{
+		// Note: Floating point is excluded, since a NaN compares false both ways and would leave min/max unable to cover
+		// the rest of its block.
+		template <typename T>
+		concept ZoneMappable = std::totally_ordered<T> && std::is_trivially_copyable_v<T> && !std::floating_point<T>;
+
+		// Note: min/max of one block of a column
+		template <typename T>
+		struct Zone
+		{
+			T min;
+			T max;
+		};
+
+		struct NoZoneMap
+		{
+			// Nothing
+		};
+
+		template <typename T>
+		struct ZoneMapColumn
+		{
+			using type = NoZoneMap;
+		};
+
+		template <ZoneMappable T>
+		struct ZoneMapColumn<T>
+		{
+			using type = std::vector<Zone<T>>;
+		};
+
+		template <typename T>
+		using ZoneMapColumn_t = typename ZoneMapColumn<T>::type;
+
+		// Note: Can any value in [min, max] satisfy "value comparison"?
+		template <InternalTaggedTuple::TagComparison comparison, typename T, typename Value>
+		constexpr bool MayMatch(Zone<T> const& zone, Value const& value)
+		{
+			using InternalTaggedTuple::TagComparison;
+
+			if constexpr (comparison == TagComparison::Equal)
+			{
+				return !(value < zone.min) && !(zone.max < value);
+			}
+
+			if constexpr (comparison == TagComparison::NotEqual)
+			{
+				return !(zone.min == zone.max && zone.min == value);
+			}
+
+			if constexpr (comparison == TagComparison::LessThan)
+			{
+				return zone.min < value;
+			}
+
+			if constexpr (comparison == TagComparison::GreaterThan)
+			{
+				return value < zone.max;
+			}
+
+			if constexpr (comparison == TagComparison::LessThanOrEqual)
+			{
+				return !(value < zone.min);
+			}
+
+			if constexpr (comparison == TagComparison::GreaterThanOrEqual)
+			{
+				return !(zone.max < value);
+			}
+		}
+
+		inline void Prefetch(void const* p)
+		{
+#if defined(__AVX2__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+			_mm_prefetch(static_cast<char const*>(p), _MM_HINT_T0);
+#elif defined(__GNUC__)
+			__builtin_prefetch(p);
+#endif
+		}
+
+		inline constexpr std::size_t default_prefetch_distance{ 16 };
+
+#if defined(__AVX2__)
+		// Returns the number of rows gathered; the caller finishes the tail.
+		// Note: Indices are treated as int32 by the gather instructions, so source must have fewer than 2^31 rows.
+		template <std::size_t prefetch_distance, typename T>
+		std::size_t GatherAvx2(T const* source, std::span<std::uint32_t const> rows, T* destination)
+		{
+			constexpr std::size_t lanes{ 32 / sizeof(T) };
+			auto const n{ std::size(rows) };
+			std::size_t i{};
+
+			for (; i + lanes <= n; i += lanes)
+			{
+				for (auto j{ i + prefetch_distance }, end{ std::min(j + lanes, n) }; j < end; ++j)
+				{
+					Prefetch(source + rows[j]);
+				}
+
+				if constexpr (sizeof(T) == 4)
+				{
+					auto index{ _mm256_loadu_si256(reinterpret_cast<__m256i const*>(std::data(rows) + i)) };
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_i32gather_epi32(reinterpret_cast<int const*>(source), index, 4));
+				}
+				else
+				{
+					auto index{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(std::data(rows) + i)) };
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_i32gather_epi64(reinterpret_cast<long long const*>(source), index, 8));
+				}
+			}
+
+			return i;
+		}
+#endif
+
+		template <std::size_t prefetch_distance, typename T, typename Index>
+		void GatherColumn(std::vector<T> const& source, std::span<Index const> rows, std::vector<T>& destination)
+		{
+			auto const n{ std::size(rows) };
+			std::size_t i{};
+
+			if constexpr (std::is_trivially_copyable_v<T>)
+			{
+				destination.resize(n);
+
+#if defined(__AVX2__)
+				if constexpr (std::is_same_v<Index, std::uint32_t> && (sizeof(T) == 4 || sizeof(T) == 8))
+				{
+					if (std::size(source) <= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+					{
+						i = GatherAvx2<prefetch_distance>(std::data(source), rows, std::data(destination));
+					}
+				}
+#endif
+
+				for (; i != n; ++i)
+				{
+					if (i + prefetch_distance < n)
+					{
+						Prefetch(std::data(source) + rows[i + prefetch_distance]);
+					}
+
+					destination[i] = source[rows[i]];
+				}
+			}
+			else
+			{
+				destination.clear();
+				destination.reserve(n);
+
+				for (; i != n; ++i)
+				{
+					if (i + prefetch_distance < n)
+					{
+						Prefetch(std::data(source) + rows[i + prefetch_distance]);
+					}
+
+					destination.push_back(source[rows[i]]);
+				}
+			}
+		}
+	}
+
+	// Note: zone_map_block_size != 0 keeps per-block min/max of every ordered, trivially copyable column
+	// and lets Filter() skip blocks that cannot match.
+	template <typename TT, std::size_t zone_map_block_size = 0>
 	class SoaVector;
 
-	template <auto... Tags, typename... Ts, auto... Inits>
-	class SoaVector<TaggedTuple<Member<Tags, Ts, Inits>...>>
+	template <auto... Tags, typename... Ts, auto... Inits, std::size_t zone_map_block_size>
+	class SoaVector<TaggedTuple<Member<Tags, Ts, Inits>...>, zone_map_block_size>
 	{
 		using TT = TaggedTuple<Member<Tags, Ts, Inits>...>;
+		using ZoneMaps = std::conditional_t<
+			zone_map_block_size == 0,
+			InternalSoaVector::NoZoneMap,
+			TaggedTuple<Member<Tags, InternalSoaVector::ZoneMapColumn_t<TaggedTupleValueType_t<Tags, TT>>>...>
+		>;
 
 		TaggedTuple<Member<Tags, std::vector<TaggedTupleValueType_t<Tags, TT>>>...> vs;
+		ZoneMaps zone_maps;
+		std::vector<bool> stale_blocks;		// Blocks whose zones may no longer cover their rows
+		bool zone_maps_dirty{ false };		// Every zone, since Vectors() handed out whole columns
 
 	public:
 		SoaVector() = default;
-		
-		
+
+
 		decltype(auto) Vectors()
 		{
+			MarkZoneMapsDirty();
+
 			return (vs);
 		}
 
@@ -31,19 +222,63 @@ namespace NDataStructure
 
 		void push_back(TT t)
 		{
+			if constexpr (zone_map_block_size != 0)
+			{
+				if (!zone_maps_dirty)
+				{
+					if (size() % zone_map_block_size == 0)
+					{
+						stale_blocks.push_back(false);
+					}
+
+					(AppendZone<Tags>(Get<Tags>(t)), ...);
+				}
+			}
+
 			(Get<Tags>(vs).push_back(Get<Tags>(t)), ...);
 		}
 
 		void pop_back()
 		{
 			(Get<Tags>(vs).pop_back(), ...);
+
+			if constexpr (zone_map_block_size != 0)
+			{
+				if (!zone_maps_dirty)
+				{
+					auto const blocks{ BlockCount() };
+
+					stale_blocks.resize(blocks);
+
+					if (blocks != 0)
+					{
+						RebuildZones(blocks - 1);
+					}
+					else
+					{
+						zone_maps = {};
+					}
+				}
+			}
 		}
 
 		void clear()
 		{
 			(Get<Tags>(vs).clear(), ...);
+
+			if constexpr (zone_map_block_size != 0)
+			{
+				zone_maps = {};
+				stale_blocks.clear();
+				zone_maps_dirty = false;
+			}
 		}
-		
+
+		void reserve(std::size_t n)
+		{
+			(Get<Tags>(vs).reserve(n), ...);
+		}
+
 		std::size_t size() const
 		{
 			return std::size(First());
@@ -54,14 +289,18 @@ namespace NDataStructure
 			return std::empty(First());
 		}
 
+		// Note: Marks the zones of row i's block stale, since the row may be written through the result.
+		// Read through std::as_const or write with Set() to keep that block prunable.
 		auto operator[](std::size_t i)
 		{
+			MarkBlockStale(i);
+
 			return TaggedTupleRef_t<TT>((tag<Tags> = std::ref(Get<Tags>(vs)[i]))...);
 		}
 
 		auto operator[](std::size_t i) const
 		{
-			return TaggedTupleRef_t<TT>((tag<Tags> = std::ref(Get<Tags>(vs)[i]))...);;
+			return TaggedTupleRef_t<TaggedTuple<Member<Tags, Ts, Inits> const...>>((tag<Tags> = std::cref(Get<Tags>(vs)[i]))...);
 		}
 
 		auto front()
@@ -74,6 +313,116 @@ namespace NDataStructure
 			return (*this)[size() - 1];
 		}
 
+		// Writes one member of row i and widens the zones of its block, so the block stays prunable.
+		template <InternalTaggedTuple::FixedString fs, typename Value>
+		void Set(std::size_t i, Value&& value)
+		{
+			auto& element{ Get<fs>(vs)[i] };
+
+			element = std::forward<Value>(value);
+
+			if constexpr (zone_map_block_size != 0)
+			{
+				if (!zone_maps_dirty)
+				{
+					WidenZone<fs>(i / zone_map_block_size, element);
+				}
+			}
+		}
+
+		// Returns indices of rows satisfying all TagRelops predicates (e.g. tag<"a"> >= 1, tag<"a"> < 10).
+		// Note: Filter() scans stale blocks in full: the block of a row taken by non-const operator[], and every block
+		// after Vectors() or a mutable Get<> of a column. RebuildZoneMaps() refreshes them.
+		// Filter() never writes, so concurrent const calls are safe.
+		template <typename... Predicates>
+		std::vector<std::size_t> Filter(Predicates const&... predicates) const
+		{
+			std::vector<std::size_t> result;
+			auto const n{ size() };
+
+			if constexpr (zone_map_block_size == 0)
+			{
+				for (std::size_t i{}; i != n; ++i)
+				{
+					if ((Matches(i, predicates) && ...))
+					{
+						result.push_back(i);
+					}
+				}
+			}
+			else
+			{
+				for (std::size_t block{}, begin{}; begin < n; ++block, begin += zone_map_block_size)
+				{
+					if (!IsStale(block) && !(MayMatchBlock(block, predicates) && ...))
+					{
+						continue;
+					}
+
+					for (auto i{ begin }, end{ std::min(begin + zone_map_block_size, n) }; i != end; ++i)
+					{
+						if ((Matches(i, predicates) && ...))
+						{
+							result.push_back(i);
+						}
+					}
+				}
+			}
+
+			return result;
+		}
+
+		// New SoaVector whose row i is row rows[i] of this one. Copies column by column, prefetching
+		// prefetch_distance rows ahead (and using AVX2 gathers for 4/8 byte columns when available).
+		template <std::size_t prefetch_distance = InternalSoaVector::default_prefetch_distance, std::unsigned_integral Index>
+		SoaVector Gather(std::span<Index const> rows) const
+		{
+			SoaVector result;
+
+			(InternalSoaVector::GatherColumn<prefetch_distance>(Get<Tags>(vs), rows, Get<Tags>(result.vs)), ...);
+			result.MarkZoneMapsDirty();
+			result.RebuildZoneMaps();
+
+			return result;
+		}
+
+		// Recomputes the zones of stale blocks only, or of every block after Vectors().
+		void RebuildZoneMaps()
+		{
+			if constexpr (zone_map_block_size != 0)
+			{
+				if (zone_maps_dirty)
+				{
+					(RebuildZoneMap<Tags>(), ...);
+					stale_blocks.assign(BlockCount(), false);
+					zone_maps_dirty = false;
+
+					return;
+				}
+
+				for (std::size_t block{}; block != std::size(stale_blocks); ++block)
+				{
+					if (stale_blocks[block])
+					{
+						RebuildZones(block);
+					}
+				}
+			}
+		}
+
+		// Number of blocks Filter() has to scan without consulting their zones.
+		std::size_t StaleBlocks() const
+		{
+			if constexpr (zone_map_block_size == 0)
+			{
+				return 0;
+			}
+			else
+			{
+				return zone_maps_dirty ? BlockCount() : static_cast<std::size_t>(std::ranges::count(stale_blocks, true));
+			}
+		}
+
 	private:
 		template <auto Tag, auto...>
 		decltype(auto) FirstHelper()
@@ -96,23 +445,192 @@ namespace NDataStructure
 		{
 			return FirstHelper<Tags...>();
 		}
+
+		void MarkZoneMapsDirty()
+		{
+			if constexpr (zone_map_block_size != 0)
+			{
+				zone_maps_dirty = true;
+			}
+		}
+
+		void MarkBlockStale(std::size_t i)
+		{
+			if constexpr (zone_map_block_size != 0)
+			{
+				if (!zone_maps_dirty)
+				{
+					stale_blocks[i / zone_map_block_size] = true;
+				}
+			}
+		}
+
+		bool IsStale(std::size_t block) const
+		{
+			return zone_maps_dirty || stale_blocks[block];
+		}
+
+		std::size_t BlockCount() const
+		{
+			return (size() + zone_map_block_size - 1) / zone_map_block_size;
+		}
+
+		template <auto Tag, typename T>
+		void AppendZone(T const& value)
+		{
+			if constexpr (InternalSoaVector::ZoneMappable<T>)
+			{
+				auto& zones{ Get<Tag>(zone_maps) };
+
+				if (size() % zone_map_block_size == 0)
+				{
+					zones.push_back({ value, value });
+				}
+				else
+				{
+					WidenZone<Tag>(std::size(zones) - 1, value);
+				}
+			}
+		}
+
+		template <auto Tag, typename T>
+		void WidenZone(std::size_t block, T const& value)
+		{
+			if constexpr (InternalSoaVector::ZoneMappable<T>)
+			{
+				auto& zone{ Get<Tag>(zone_maps)[block] };
+
+				zone.min = std::min(zone.min, value);
+				zone.max = std::max(zone.max, value);
+			}
+		}
+
+		// Recomputes the zones of one block from its rows, resizing the zone maps to the current block count.
+		void RebuildZones(std::size_t block)
+		{
+			(RebuildZone<Tags>(block), ...);
+			stale_blocks[block] = false;
+		}
+
+		template <auto Tag>
+		void RebuildZone(std::size_t block)
+		{
+			using T = TaggedTupleValueType_t<Tag, TT>;
+
+			if constexpr (InternalSoaVector::ZoneMappable<T>)
+			{
+				auto& zones{ Get<Tag>(zone_maps) };
+				std::span const column{ Get<Tag>(std::as_const(vs)) };
+				auto const begin{ block * zone_map_block_size };
+
+				zones.resize(BlockCount());
+				zones[block] = MakeZone(column.subspan(begin, std::min(zone_map_block_size, std::size(column) - begin)));
+			}
+		}
+
+		template <auto Tag>
+		void RebuildZoneMap()
+		{
+			using T = TaggedTupleValueType_t<Tag, TT>;
+
+			if constexpr (InternalSoaVector::ZoneMappable<T>)
+			{
+				auto& zones{ Get<Tag>(zone_maps) };
+				std::span const column{ Get<Tag>(std::as_const(vs)) };
+
+				zones.clear();
+
+				for (std::size_t begin{}; begin < std::size(column); begin += zone_map_block_size)
+				{
+					zones.push_back(MakeZone(column.subspan(begin, std::min(zone_map_block_size, std::size(column) - begin))));
+				}
+			}
+		}
+
+		template <typename T>
+		static InternalSoaVector::Zone<T> MakeZone(std::span<T const> values)
+		{
+			auto [min, max]{ std::minmax_element(std::begin(values), std::end(values)) };
+
+			return { *min, *max };
+		}
+
+		template <typename Value>
+		static constexpr Value const& ValueAt(std::size_t, Value const& value)
+		{
+			return value;
+		}
+
+		template <typename Tag>
+			requires InternalTaggedTuple::is_tuple_tag_v<Tag>
+		auto const& ValueAt(std::size_t i, Tag const&) const
+		{
+			return Get<Tag::value>(vs)[i];
+		}
+
+		template <typename TagOrValue1, typename TagOrValue2, InternalTaggedTuple::TagComparison comparison>
+		bool Matches(std::size_t i, InternalTaggedTuple::TagComparatorPredicate<TagOrValue1, TagOrValue2, comparison> const& predicate) const
+		{
+			return InternalTaggedTuple::Compare<comparison>(ValueAt(i, predicate.tag_or_value1), ValueAt(i, predicate.tag_or_value2));
+		}
+
+		template <typename TagOrValue1, typename TagOrValue2, InternalTaggedTuple::TagComparison comparison>
+		bool MayMatchBlock(std::size_t block, InternalTaggedTuple::TagComparatorPredicate<TagOrValue1, TagOrValue2, comparison> const& predicate) const
+		{
+			using InternalTaggedTuple::is_tuple_tag_v;
+
+			if constexpr (is_tuple_tag_v<TagOrValue1> && !is_tuple_tag_v<TagOrValue2>)
+			{
+				return MayMatchZone<TagOrValue1, comparison>(block, predicate.tag_or_value2);
+			}
+			else if constexpr (!is_tuple_tag_v<TagOrValue1> && is_tuple_tag_v<TagOrValue2>)
+			{
+				return MayMatchZone<TagOrValue2, InternalTaggedTuple::Mirror(comparison)>(block, predicate.tag_or_value1);
+			}
+			else
+			{
+				return true;
+			}
+		}
+
+		template <typename Tag, InternalTaggedTuple::TagComparison comparison, typename Value>
+		bool MayMatchZone(std::size_t block, Value const& value) const
+		{
+			auto const& zones{ Get<Tag::value>(zone_maps) };
+
+			if constexpr (std::is_same_v<std::remove_cvref_t<decltype(zones)>, InternalSoaVector::NoZoneMap>)
+			{
+				return true;
+			}
+			else
+			{
+				return InternalSoaVector::MayMatch<comparison>(zones[block], value);
+			}
+		}
 	};
 
-	template <typename Tag, typename TT>
-	decltype(auto) GetImpl(SoaVector<TT>& s)
+	template <typename Tag, typename TT, std::size_t N>
+	decltype(auto) GetImpl(SoaVector<TT, N>& s)
 	{
 		return std::span{ Get<Tag::value>(s.Vectors()) };
 	}
 
-	template <typename Tag, typename TT>
-	auto GetImpl(SoaVector<TT> const& s)
+	template <typename Tag, typename TT, std::size_t N>
+	auto GetImpl(SoaVector<TT, N> const& s)
 	{
 		return std::span{ Get<Tag::value>(s.Vectors()) };
 	}
 
-	template <typename Tag, typename TT>
-	auto GetImpl(SoaVector<TT>&& s)
+	template <typename Tag, typename TT, std::size_t N>
+	auto GetImpl(SoaVector<TT, N>&& s)
+	{
+		return std::span{ Get<Tag::value>(std::move(s.Vectors())) };
+	}
+
+	template <std::size_t prefetch_distance = InternalSoaVector::default_prefetch_distance, typename TT, std::size_t N, std::ranges::contiguous_range Rows>
+		requires std::unsigned_integral<std::ranges::range_value_t<Rows>>
+	SoaVector<TT, N> Gather(SoaVector<TT, N> const& soa, Rows const& rows)
 	{
-		return std::span{ Get<Tag::value>(std::move(s.Vectors())) }; 
+		return soa.template Gather<prefetch_distance>(std::span<std::ranges::range_value_t<Rows> const>{ rows });
 	}
 }
\ No newline at end of file
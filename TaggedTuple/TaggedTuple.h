@@ -717,9 +717,65 @@ namespace NDataStructure
 			GreaterThanOrEqual
 		};
 
+		template <TagComparison comparison, typename A, typename B>
+		constexpr bool Compare(A const& a, B const& b)
+		{
+			if constexpr (comparison == TagComparison::Equal)
+			{
+				return a == b;
+			}
+
+			if constexpr (comparison == TagComparison::NotEqual)
+			{
+				return a != b;
+			}
+
+			if constexpr (comparison == TagComparison::LessThan)
+			{
+				return a < b;
+			}
+
+			if constexpr (comparison == TagComparison::GreaterThan)
+			{
+				return a > b;
+			}
+
+			if constexpr (comparison == TagComparison::LessThanOrEqual)
+			{
+				return a <= b;
+			}
+
+			if constexpr (comparison == TagComparison::GreaterThanOrEqual)
+			{
+				return a >= b;
+			}
+		}
+
+		// Note: a op b == b Mirror(op) a
+		constexpr TagComparison Mirror(TagComparison comparison)
+		{
+			switch (comparison)
+			{
+			case TagComparison::LessThan:
+				return TagComparison::GreaterThan;
+			case TagComparison::GreaterThan:
+				return TagComparison::LessThan;
+			case TagComparison::LessThanOrEqual:
+				return TagComparison::GreaterThanOrEqual;
+			case TagComparison::GreaterThanOrEqual:
+				return TagComparison::LessThanOrEqual;
+			default:
+				return comparison;
+			}
+		}
+
 		template <typename TagOrValue1, typename TagOrValue2, TagComparison comparison>
 		struct TagComparatorPredicate
 		{
+			using FirstType = TagOrValue1;
+			using SecondType = TagOrValue2;
+			static constexpr TagComparison tag_comparison{ comparison };
+
 			template <typename Value, typename TS>
 			constexpr static const auto& GetValueForComparison(Value const& value, TS const&)
 			{
@@ -742,35 +798,7 @@ namespace NDataStructure
 				auto const& a{ GetValueForComparison(tag_or_value1, ts) };
 				auto const& b{ GetValueForComparison(tag_or_value2, ts) };
 
-				if constexpr (comparison == TagComparison::Equal)
-				{
-					return a == b;
-				}
-				
-				if constexpr (comparison == TagComparison::NotEqual)
-				{
-					return a != b;
-				}
-
-				if constexpr (comparison == TagComparison::LessThan)
-				{
-					return a < b;
-				}
-
-				if constexpr (comparison == TagComparison::GreaterThan)
-				{
-					return a > b;
-				}
-
-				if constexpr (comparison == TagComparison::LessThanOrEqual)
-				{
-					return a <= b;
-				}
-
-				if constexpr (comparison == TagComparison::GreaterThanOrEqual)
-				{
-					return a >= b;
-				}
+				return Compare<comparison>(a, b);
 			}
 		};
 
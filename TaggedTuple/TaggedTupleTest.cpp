@@ -1,6 +1,14 @@
 #include <catch.hpp>
+#include "PackedColumn.h"
 #include "SoaVector.h"
 #include "ToFromNlohmannJson.h"
+#include "TrackedTuple.h"
+#include "VersionedSoaVector.h"
+#include <atomic>
+#include <bitset>
+#include <limits>
+#include <thread>
+#include <utility>
 
 using namespace NDataStructure;
 using namespace std::string_literals;
@@ -187,6 +195,376 @@ TEST_CASE("SoaVector", "[Basic]")
 	REQUIRE(*std::max_element(std::begin(scores), std::end(scores)) == 12.5);
 }
 
+TEST_CASE("SoaVectorZoneMapFilter", "[SoaVector]")
+{
+	using namespace TagRelops;
+	using Login = TaggedTuple<
+		Member<"id", std::int64_t>,
+		Member<"name", std::string>,
+		Member<"last_login_time", std::int64_t>
+	>;
+
+	SoaVector<Login> plain;
+	SoaVector<Login, 4> zoned;
+
+	for (std::int64_t i{}; i != 18; ++i)
+	{
+		Login login{ tag<"id"> = i, tag<"name"> = std::to_string(i), tag<"last_login_time"> = 100 + i * 10 };
+
+		plain.push_back(login);
+		zoned.push_back(login);
+	}
+
+	auto window{ zoned.Filter(tag<"last_login_time"> >= 150, tag<"last_login_time"> < 200) };
+
+	REQUIRE(window == std::vector<std::size_t>{ 5, 6, 7, 8, 9 });
+	REQUIRE(window == plain.Filter(tag<"last_login_time"> >= 150, tag<"last_login_time"> < 200));
+	REQUIRE(zoned.Filter(260 <= tag<"last_login_time">) == std::vector<std::size_t>{ 16, 17 });
+	REQUIRE(zoned.Filter(tag<"name"> == "3"s) == std::vector<std::size_t>{ 3 });
+	REQUIRE(zoned.Filter(tag<"last_login_time"> > 1000).empty());
+
+	zoned.pop_back();
+	zoned.pop_back();
+
+	REQUIRE(zoned.Filter(tag<"last_login_time"> >= 250) == std::vector<std::size_t>{ 15 });
+
+	Get<"last_login_time">(zoned)[0] = 1000;
+
+	REQUIRE(zoned.Filter(tag<"last_login_time"> > 500) == std::vector<std::size_t>{ 0 });
+
+	zoned.RebuildZoneMaps();
+
+	REQUIRE(zoned.Filter(tag<"last_login_time"> > 500) == std::vector<std::size_t>{ 0 });
+	REQUIRE(std::as_const(zoned).Filter(tag<"last_login_time"> < 130) == std::vector<std::size_t>{ 1, 2 });
+	REQUIRE(zoned.StaleBlocks() == 0);
+
+	auto const id{ Get<"id">(zoned[5]) };
+
+	REQUIRE(id == 5);
+	REQUIRE(zoned.StaleBlocks() == 1);
+	REQUIRE(zoned.Filter(tag<"last_login_time"> > 500) == std::vector<std::size_t>{ 0 });
+
+	auto row{ zoned[6] };
+
+	Get<"last_login_time">(row) = 2000;
+	zoned.Set<"last_login_time">(9, 3000);
+
+	REQUIRE(zoned.StaleBlocks() == 1);
+	REQUIRE(zoned.Filter(tag<"last_login_time"> > 1500) == std::vector<std::size_t>{ 6, 9 });
+
+	zoned.RebuildZoneMaps();
+
+	REQUIRE(zoned.StaleBlocks() == 0);
+	REQUIRE(zoned.Filter(tag<"last_login_time"> > 1500) == std::vector<std::size_t>{ 6, 9 });
+	REQUIRE(zoned.Filter(tag<"last_login_time"> > 2500) == std::vector<std::size_t>{ 9 });
+
+	using Sample = TaggedTuple<Member<"value", double>>;
+
+	static_assert(!InternalSoaVector::ZoneMappable<double>);
+
+	SoaVector<Sample> plain_samples;
+	SoaVector<Sample, 4> zoned_samples;
+
+	for (double value : { std::numeric_limits<double>::quiet_NaN(), 1.0, 5.0, 2.0, 3.0 })
+	{
+		plain_samples.push_back({ tag<"value"> = value });
+		zoned_samples.push_back({ tag<"value"> = value });
+	}
+
+	REQUIRE(zoned_samples.Filter(tag<"value"> > 4.0) == std::vector<std::size_t>{ 2 });
+	REQUIRE(zoned_samples.Filter(tag<"value"> > 4.0) == plain_samples.Filter(tag<"value"> > 4.0));
+}
+
+TEST_CASE("SoaVectorGather", "[SoaVector]")
+{
+	using namespace TagRelops;
+	using Row = TaggedTuple<
+		Member<"name", std::string>,
+		Member<"id", std::int64_t>,
+		Member<"score", float>
+	>;
+
+	SoaVector<Row, 8> v;
+
+	for (std::int64_t i{}; i != 100; ++i)
+	{
+		v.push_back({ tag<"name"> = std::to_string(i), tag<"id"> = i, tag<"score"> = i * 0.5f });
+	}
+
+	std::vector<std::uint32_t> rows;
+
+	for (std::uint32_t i{}; i != 37; ++i)
+	{
+		rows.push_back((i * 31) % 100);
+	}
+
+	auto gathered{ Gather(v, rows) };
+
+	REQUIRE(std::size(gathered) == std::size(rows));
+
+	for (std::size_t i{}; i != std::size(rows); ++i)
+	{
+		REQUIRE(Get<"name">(gathered[i]) == std::to_string(rows[i]));
+		REQUIRE(Get<"id">(gathered[i]) == rows[i]);
+		REQUIRE(Get<"score">(gathered[i]) == rows[i] * 0.5f);
+	}
+
+	REQUIRE(gathered.Filter(tag<"id"> < 10) == std::vector<std::size_t>{ 0, 13, 26 });
+
+	auto selected{ Gather<0>(v, v.Filter(tag<"id"> >= 95)) };
+
+	REQUIRE(std::ranges::equal(Get<"id">(selected), std::vector<std::int64_t>{ 95, 96, 97, 98, 99 }));
+}
+
+TEST_CASE("PackedColumnRoundTrip", "[SoaVector]")
+{
+	std::vector<std::int64_t> values;
+
+	for (std::int64_t i{}; i != 1000; ++i)
+	{
+		values.push_back(1'600'000'000'000'000 + i * 1000 + (i * 7919) % 13);
+	}
+
+	values[500] = std::numeric_limits<std::int64_t>::min();
+	values[501] = std::numeric_limits<std::int64_t>::max();
+
+	for (auto encoding : { PackedEncoding::FrameOfReference, PackedEncoding::Delta, PackedEncoding::Adaptive })
+	{
+		PackedColumn<std::int64_t> column{ values, encoding };
+
+		REQUIRE(std::size(column) == std::size(values));
+		REQUIRE(column.Unpack() == values);
+		REQUIRE(column[0] == values[0]);
+		REQUIRE(column[501] == values[501]);
+		REQUIRE(column[999] == values[999]);
+		REQUIRE(column.MemoryUsage() < std::size(values) * sizeof(std::int64_t) / 2);
+	}
+}
+
+TEST_CASE("SealedSoaVectorFilter", "[SoaVector]")
+{
+	using namespace TagRelops;
+	using Login = TaggedTuple<
+		Member<"id", std::int64_t>,
+		Member<"name", std::string>,
+		Member<"last_login_time", std::int64_t>
+	>;
+
+	SoaVector<Login> v;
+
+	for (std::int64_t i{}; i != 1000; ++i)
+	{
+		v.push_back({ tag<"id"> = i % 17, tag<"name"> = std::to_string(i), tag<"last_login_time"> = 100'000 + i * 10 });
+	}
+
+	SealedSoaVector<Login> sealed{ v, PackedEncoding::Adaptive };
+
+	REQUIRE(std::size(sealed) == std::size(v));
+	REQUIRE(Get<"name">(sealed[123]) == "123");
+	REQUIRE(Get<"last_login_time">(sealed[123]) == 101'230);
+	REQUIRE(sealed.Filter(tag<"last_login_time"> >= 105'000, tag<"last_login_time"> < 106'000, tag<"id"> == 3)
+		== v.Filter(tag<"last_login_time"> >= 105'000, tag<"last_login_time"> < 106'000, tag<"id"> == 3));
+	REQUIRE(sealed.Filter(tag<"id"> != 0, tag<"name"> == "999"s) == std::vector<std::size_t>{ 999 });
+	REQUIRE(sealed.Filter(200'000 < tag<"last_login_time">).empty());
+	REQUIRE(sealed.Filter(tag<"id"> >= tag<"last_login_time">).empty());
+	REQUIRE(sealed.Filter(tag<"last_login_time"> > tag<"id">, tag<"id"> == 3) == v.Filter(tag<"last_login_time"> > tag<"id">, tag<"id"> == 3));
+
+	auto unsealed{ sealed.Unseal() };
+
+	REQUIRE(std::ranges::equal(Get<"last_login_time">(unsealed), Get<"last_login_time">(v)));
+}
+
+TEST_CASE("SealedSoaVectorMixedTypeFilter", "[SoaVector]")
+{
+	using namespace TagRelops;
+	using Sample = TaggedTuple<
+		Member<"id", std::int64_t>,
+		Member<"small", std::int8_t>
+	>;
+
+	SoaVector<Sample> v;
+
+	for (std::int64_t i{}; i != 300; ++i)
+	{
+		v.push_back({ tag<"id"> = i % 5, tag<"small"> = static_cast<std::int8_t>(i % 256 - 128) });
+	}
+
+	for (auto encoding : { PackedEncoding::FrameOfReference, PackedEncoding::Delta })
+	{
+		SealedSoaVector<Sample> sealed{ v, encoding };
+
+		REQUIRE(sealed.Filter(tag<"id"> < 2.5) == v.Filter(tag<"id"> < 2.5));
+		REQUIRE(sealed.Filter(tag<"id"> == 2.0) == v.Filter(tag<"id"> == 2.0));
+		REQUIRE(sealed.Filter(tag<"id"> != 2.5).size() == 300);
+		REQUIRE(sealed.Filter(tag<"small"> < 300) == v.Filter(tag<"small"> < 300));
+		REQUIRE(sealed.Filter(tag<"small"> < 300).size() == 300);
+		REQUIRE(sealed.Filter(tag<"small"> == 300).empty());
+		REQUIRE(sealed.Filter(tag<"small"> > -129.5) == v.Filter(tag<"small"> > -129.5));
+		REQUIRE(sealed.Filter(tag<"small"> < 0u) == v.Filter(tag<"small"> < 0u));
+		REQUIRE(sealed.Filter(tag<"id"> >= std::uint64_t{ 3 }) == v.Filter(tag<"id"> >= std::uint64_t{ 3 }));
+	}
+}
+
+TEST_CASE("VersionedSoaVectorSnapshot", "[SoaVector]")
+{
+	using namespace TagRelops;
+	using Person = TaggedTuple<
+		Member<"name", std::string>,
+		Member<"id", std::int64_t>
+	>;
+
+	VersionedSoaVector<Person, 4> v;
+
+	for (std::int64_t i{}; i != 10; ++i)
+	{
+		v.push_back({ tag<"name"> = std::to_string(i), tag<"id"> = i });
+	}
+
+	auto before{ v.Publish() };
+
+	Get<"name">(v[1]) = "changed";
+	v.push_back({ tag<"name"> = "10"s, tag<"id"> = std::int64_t{ 10 } });
+
+	REQUIRE(std::size(before) == 10);
+	REQUIRE(Get<"name">(before[1]) == "1");
+	REQUIRE(std::size(v.Snapshot()) == 10);
+
+	auto after{ v.Publish() };
+
+	REQUIRE(std::size(after) == 11);
+	REQUIRE(Get<"name">(after[1]) == "changed");
+	REQUIRE(Get<"name">(v.Snapshot()[10]) == "10");
+	REQUIRE(after.Filter(tag<"id"> >= 9) == std::vector<std::size_t>{ 9, 10 });
+
+	std::vector<void const*> before_chunks;
+	std::vector<void const*> after_chunks;
+
+	before.ForEachChunk([&](auto const& rows, std::size_t) { before_chunks.push_back(&rows); });
+	after.ForEachChunk([&](auto const& rows, std::size_t) { after_chunks.push_back(&rows); });
+
+	REQUIRE(before_chunks[0] != after_chunks[0]);	// Copied on write
+	REQUIRE(before_chunks[1] == after_chunks[1]);	// Shared
+	REQUIRE(before_chunks[2] != after_chunks[2]);
+}
+
+TEST_CASE("VersionedSoaVectorZoneMaps", "[SoaVector]")
+{
+	using namespace TagRelops;
+	using Row = TaggedTuple<Member<"id", std::int64_t>>;
+
+	VersionedSoaVector<Row, 8, 4> v;
+
+	for (std::int64_t i{}; i != 16; ++i)
+	{
+		v.push_back({ tag<"id"> = i });
+	}
+
+	v.Publish();
+
+	auto row{ v[1] };
+
+	Get<"id">(row) = 100;
+	v.push_back({ tag<"id"> = std::int64_t{ 16 } });
+
+	auto snapshot{ v.Publish() };
+	std::size_t stale_blocks{};
+
+	snapshot.ForEachChunk([&](auto const& rows, std::size_t) { stale_blocks += rows.StaleBlocks(); });
+
+	REQUIRE(stale_blocks == 0);
+	REQUIRE(snapshot.Filter(tag<"id"> >= 15) == std::vector<std::size_t>{ 1, 15, 16 });
+	REQUIRE(snapshot.Filter(tag<"id"> == 5) == std::vector<std::size_t>{ 5 });
+}
+
+TEST_CASE("VersionedSoaVectorConcurrentReaders", "[SoaVector]")
+{
+	using Row = TaggedTuple<Member<"id", std::int64_t>>;
+
+	VersionedSoaVector<Row, 64> v;
+	std::atomic<bool> done{ false };
+	std::atomic<bool> consistent{ true };
+
+	std::thread reader{ [&] {
+		while (!done)
+		{
+			auto snapshot{ v.Snapshot() };
+			std::int64_t sum{};
+
+			snapshot.ForEachChunk([&](auto const& rows, std::size_t) {
+				for (auto id : Get<"id">(rows))
+				{
+					sum += id;
+				}
+			});
+
+			auto const n{ static_cast<std::int64_t>(std::size(snapshot)) };
+
+			if (sum != n * (n - 1) / 2)
+			{
+				consistent = false;
+			}
+		}
+	} };
+
+	for (std::int64_t i{}; i != 5000; ++i)
+	{
+		v.push_back({ tag<"id"> = i });
+
+		if (i % 7 == 0)
+		{
+			v.Publish();
+		}
+	}
+
+	done = true;
+	reader.join();
+
+	REQUIRE(consistent);
+}
+
+TEST_CASE("TrackedDirtyTags", "[TaggedTuple]")
+{
+	using namespace Literals;
+	using Account = TaggedTuple<
+		Member<"id", std::int64_t>,
+		Member<"name", std::string>,
+		Member<"score", int>
+	>;
+
+	Tracked<Account> account{ Account{ tag<"id"> = std::int64_t{ 1 }, tag<"name"> = "first"s, tag<"score"> = 10 } };
+	auto const& view{ account };
+
+	REQUIRE(Get<"name">(view) == "first");
+	REQUIRE(view["id"_tag] == 1);
+	REQUIRE(!account.Dirty());
+
+	Get<"name">(account) = "second";
+	account["score"_tag] += 5;
+
+	REQUIRE(account.DirtyTags() == Tracked<Account>::DirtyMask{ 0b110 });
+	REQUIRE(account.DirtyTags<"score", "id", "name">() == std::bitset<3>{ 0b101 });
+	REQUIRE(account.Dirty<"name">());
+	REQUIRE(!account.Dirty<"id">());
+	REQUIRE(Get<"score">(account.Value()) == 15);
+
+	std::vector<std::string_view> changed;
+
+	account.ForEachDirty([&](auto const& member) {
+		changed.push_back(member.Key());
+	});
+
+	REQUIRE(changed == std::vector<std::string_view>{ "name", "score" });
+
+	account.ClearDirty();
+
+	REQUIRE(!account.Dirty());
+
+	account.Assign(Account{ tag<"id"> = std::int64_t{ 2 } });
+
+	REQUIRE(account.DirtyTags().all());
+	REQUIRE(Get<"id">(view) == 2);
+}
+
 TEST_CASE("BasicRoundTrip", "[Json]")
 {
 	using Person = TaggedTuple<
@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include "TaggedTuple.h"
+
+namespace NDataStructure
+{
+	// TaggedTuple that records which members were handed out for writing since the last ClearDirty(),
+	// one bit per member in declaration order. Mutable Get and operator[] set the bit; const access and Value() read
+	// the tuple directly.
+	// Note: A member is dirty as soon as mutable access is taken, whether or not it is then written.
+	template <typename TT>
+	class Tracked;
+
+	template <typename... Members>
+	class Tracked<TaggedTuple<Members...>>
+	{
+	public:
+		using Tuple = TaggedTuple<Members...>;
+		using DirtyMask = std::bitset<sizeof...(Members)>;
+
+		Tracked() = default;
+
+		// Starts clean.
+		explicit Tracked(Tuple value)
+			: value{ std::move(value) }
+		{
+			// Nothing
+		}
+
+		template <InternalTaggedTuple::FixedString fs>
+		static constexpr std::size_t IndexOf()
+		{
+			constexpr std::array<std::string_view, sizeof...(Members)> tags{ InternalTaggedTuple::MemberTag<Members>()... };
+			constexpr auto index{ static_cast<std::size_t>(std::distance(std::begin(tags), std::ranges::find(tags, fs.ToStringView()))) };
+
+			static_assert(index != sizeof...(Members), "no member with this tag");
+
+			return index;
+		}
+
+		template <InternalTaggedTuple::FixedString fs>
+		constexpr decltype(auto) Mutable()
+		{
+			dirty.set(IndexOf<fs>());
+
+			return Get<fs>(value);
+		}
+
+		template <typename Tag>
+		constexpr auto& operator[](Tag)
+		{
+			return Mutable<Tag::value>();
+		}
+
+		template <typename Tag>
+		constexpr auto& operator[](Tag) const
+		{
+			return Get<Tag::value>(value);
+		}
+
+		constexpr Tuple const& Value() const
+		{
+			return value;
+		}
+
+		// Replaces every member and marks all of them dirty.
+		void Assign(Tuple new_value)
+		{
+			value = std::move(new_value);
+			dirty.set();
+		}
+
+		// Bit i is member i in declaration order.
+		DirtyMask DirtyTags() const
+		{
+			return dirty;
+		}
+
+		// Bit i is the member tagged fs[i], for a consumer that numbers columns in its own order
+		// (e.g. DirtyTags<"name", "score">() for an UPDATE of those two columns).
+		template <InternalTaggedTuple::FixedString... fs>
+			requires (sizeof...(fs) != 0)
+		std::bitset<sizeof...(fs)> DirtyTags() const
+		{
+			std::bitset<sizeof...(fs)> result;
+			std::size_t i{};
+
+			((result[i++] = dirty[IndexOf<fs>()]), ...);
+
+			return result;
+		}
+
+		template <InternalTaggedTuple::FixedString fs>
+		bool Dirty() const
+		{
+			return dirty.test(IndexOf<fs>());
+		}
+
+		bool Dirty() const
+		{
+			return dirty.any();
+		}
+
+		void ClearDirty()
+		{
+			dirty.reset();
+		}
+
+		// Calls f(member) for each dirty member, in declaration order, with the member objects ForEach passes.
+		template <typename F>
+		void ForEachDirty(F&& f) const
+		{
+			std::size_t i{};
+
+			value.ForEach([&](auto const& member) {
+				if (dirty[i++])
+				{
+					f(member);
+				}
+			});
+		}
+
+	private:
+		Tuple value;
+		DirtyMask dirty;
+	};
+
+	template <InternalTaggedTuple::FixedString fs, typename TT>
+	constexpr decltype(auto) Get(Tracked<TT>& t)
+	{
+		return t.template Mutable<fs>();
+	}
+
+	template <InternalTaggedTuple::FixedString fs, typename TT>
+	constexpr decltype(auto) Get(Tracked<TT> const& t)
+	{
+		return Get<fs>(t.Value());
+	}
+}
\ No newline at end of file
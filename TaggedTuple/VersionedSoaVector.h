@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "SoaVector.h"
+
+namespace NDataStructure
+{
+	namespace InternalVersionedSoaVector
+	{
+		template <typename TT, std::size_t zone_map_block_size>
+		struct Chunk
+		{
+			SoaVector<TT, zone_map_block_size> rows;
+			std::uint64_t epoch;	// Writer epoch that created this chunk. Frozen once that epoch is published
+		};
+
+		template <typename TT, std::size_t zone_map_block_size>
+		struct Version
+		{
+			std::vector<std::shared_ptr<Chunk<TT, zone_map_block_size> const>> chunks;
+			std::size_t size;
+			std::uint64_t epoch;
+		};
+	}
+
+	// Immutable view of a VersionedSoaVector. Chunks are shared with the writer and with other snapshots,
+	// and are released when the last snapshot referencing them goes away.
+	template <typename TT, std::size_t chunk_size = 4096, std::size_t zone_map_block_size = 0>
+	class SoaVectorSnapshot
+	{
+		using Version = InternalVersionedSoaVector::Version<TT, zone_map_block_size>;
+
+		std::shared_ptr<Version const> version;
+
+	public:
+		explicit SoaVectorSnapshot(std::shared_ptr<Version const> version)
+			: version{ std::move(version) }
+		{
+			// Nothing
+		}
+
+		std::size_t size() const
+		{
+			return version->size;
+		}
+
+		bool empty() const
+		{
+			return version->size == 0;
+		}
+
+		std::uint64_t Epoch() const
+		{
+			return version->epoch;
+		}
+
+		auto operator[](std::size_t i) const
+		{
+			return std::as_const(version->chunks[i / chunk_size]->rows)[i % chunk_size];
+		}
+
+		// f(SoaVector<TT, zone_map_block_size> const& rows, std::size_t first_row_index)
+		template <typename F>
+		void ForEachChunk(F&& f) const
+		{
+			for (std::size_t i{}; i != std::size(version->chunks); ++i)
+			{
+				f(version->chunks[i]->rows, i * chunk_size);
+			}
+		}
+
+		// Safe to call from any thread; chunk Filter() only reads.
+		template <typename... Predicates>
+		std::vector<std::size_t> Filter(Predicates const&... predicates) const
+		{
+			std::vector<std::size_t> result;
+
+			ForEachChunk([&](auto const& rows, std::size_t offset) {
+				for (auto i : rows.Filter(predicates...))
+				{
+					result.push_back(offset + i);
+				}
+			});
+
+			return result;
+		}
+	};
+
+	// SoaVector split into fixed-size chunks with copy-on-write snapshots.
+	// Note: One writer thread mutates and calls Publish(); any thread may call Snapshot() without locking.
+	// A chunk that has been published is never modified again; the writer copies it on its next mutation.
+	// zone_map_block_size is passed to each chunk's SoaVector, so snapshot Filter() can skip blocks inside a chunk.
+	template <typename TT, std::size_t chunk_size = 4096, std::size_t zone_map_block_size = 0>
+	class VersionedSoaVector
+	{
+		using Chunk = InternalVersionedSoaVector::Chunk<TT, zone_map_block_size>;
+		using Version = InternalVersionedSoaVector::Version<TT, zone_map_block_size>;
+		using Snapshot_t = SoaVectorSnapshot<TT, chunk_size, zone_map_block_size>;
+
+		std::vector<std::shared_ptr<Chunk>> chunks;
+		std::size_t count{};
+		std::uint64_t epoch{ 1 };
+		std::atomic<std::shared_ptr<Version const>> published;
+
+	public:
+		VersionedSoaVector()
+		{
+			published.store(std::make_shared<Version const>(Version{ {}, 0, 0 }));
+		}
+
+		VersionedSoaVector(VersionedSoaVector const&) = delete;
+		VersionedSoaVector& operator=(VersionedSoaVector const&) = delete;
+
+		void push_back(TT t)
+		{
+			if (count % chunk_size == 0)
+			{
+				chunks.push_back(std::make_shared<Chunk>(Chunk{ {}, epoch }));
+			}
+
+			MutableChunk(std::size(chunks) - 1).rows.push_back(std::move(t));
+			++count;
+		}
+
+		void pop_back()
+		{
+			MutableChunk(std::size(chunks) - 1).rows.pop_back();
+
+			if (--count % chunk_size == 0)
+			{
+				chunks.pop_back();
+			}
+		}
+
+		void clear()
+		{
+			chunks.clear();
+			count = 0;
+		}
+
+		std::size_t size() const
+		{
+			return count;
+		}
+
+		bool empty() const
+		{
+			return count == 0;
+		}
+
+		auto operator[](std::size_t i)
+		{
+			return MutableChunk(i / chunk_size).rows[i % chunk_size];
+		}
+
+		auto operator[](std::size_t i) const
+		{
+			return std::as_const(chunks[i / chunk_size]->rows)[i % chunk_size];
+		}
+
+		// Makes the current contents visible to Snapshot() and freezes every chunk.
+		// Note: Stale zones of chunks written in this epoch are rebuilt first, since a frozen chunk is never touched again.
+		Snapshot_t Publish()
+		{
+			if constexpr (zone_map_block_size != 0)
+			{
+				for (auto const& chunk : chunks)
+				{
+					if (chunk->epoch == epoch)
+					{
+						chunk->rows.RebuildZoneMaps();
+					}
+				}
+			}
+
+			auto version{ std::make_shared<Version const>(Version{ { std::begin(chunks), std::end(chunks) }, count, epoch }) };
+
+			published.store(version);
+			++epoch;
+
+			return Snapshot_t{ std::move(version) };
+		}
+
+		// Latest published version. Safe to call from any thread.
+		Snapshot_t Snapshot() const
+		{
+			return Snapshot_t{ published.load() };
+		}
+
+	private:
+		Chunk& MutableChunk(std::size_t chunk_index)
+		{
+			auto& chunk{ chunks[chunk_index] };
+
+			if (chunk->epoch != epoch)
+			{
+				chunk = std::make_shared<Chunk>(Chunk{ chunk->rows, epoch });
+			}
+
+			return *chunk;
+		}
+	};
+}
\ No newline at end of file
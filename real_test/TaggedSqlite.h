@@ -2,22 +2,39 @@
 #include "MPL.h"
 #include "Util.h"
 #include "TaggedTuple.h"
+#include "SoaVector.h"
 #include <cassert>
 #include <sqlite3.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <iostream>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <ranges>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 #include <chrono>
 #include <sstream>
 #include <filesystem>
 #include <span>
+#include <thread>
+#include <tuple>
 
 // Data ߰  εؾ ޼
 // StringToType: Ÿ 
@@ -32,6 +49,57 @@ namespace NDatabase
 	{
 		using Literals::operator""_fs;
 
+		// Non-owning view of a BLOB column.
+		// Note: std::span has no comparison operators, which every TaggedTuple member needs.
+		struct BlobView
+			: std::span<unsigned char const>
+		{
+			using std::span<unsigned char const>::span;
+
+			friend bool operator==(BlobView const& a, BlobView const& b)
+			{
+				return std::ranges::equal(a, b);
+			}
+
+			friend auto operator<=>(BlobView const& a, BlobView const& b)
+			{
+				return std::lexicographical_compare_three_way(std::begin(a), std::end(a), std::begin(b), std::end(b));
+			}
+		};
+
+		// Binds a BLOB of size zero bytes without materializing it, to be filled in place through BlobStream.
+		// Read back, it holds the size of the BLOB.
+		struct ZeroBlob
+		{
+			std::uint64_t size{};
+
+			friend auto operator<=>(ZeroBlob const&, ZeroBlob const&) = default;
+		};
+
+		// A system_clock time_point stored as an INTEGER count of Duration since the Unix epoch instead of ISO-8601 TEXT.
+		template <typename Duration>
+		struct EpochTime
+			: std::chrono::time_point<std::chrono::system_clock, Duration>
+		{
+			using std::chrono::time_point<std::chrono::system_clock, Duration>::time_point;
+
+			constexpr EpochTime() = default;
+
+			constexpr EpochTime(std::chrono::time_point<std::chrono::system_clock, Duration> t)
+				: std::chrono::time_point<std::chrono::system_clock, Duration>{ t }
+			{
+				// Nothing
+			}
+
+			auto operator<=>(EpochTime const&) const = default;
+		};
+
+		template <typename T>
+		inline constexpr bool is_epoch_time{ false };
+
+		template <typename Duration>
+		inline constexpr bool is_epoch_time<EpochTime<Duration>>{ true };
+
 		template <FixedString>
 		struct StringToType;
 
@@ -83,6 +151,18 @@ namespace NDatabase
 			using type = std::chrono::system_clock::time_point;
 		};
 
+		template <>
+		struct StringToType<"epoch">
+		{
+			using type = EpochTime<std::chrono::microseconds>;
+		};
+
+		template <>
+		struct StringToType<"epoch_ns">
+		{
+			using type = EpochTime<std::chrono::nanoseconds>;
+		};
+
 		template <>
 		struct StringToType<"path">
 		{
@@ -95,6 +175,31 @@ namespace NDatabase
 			using type = std::vector<unsigned char>;
 		};
 
+		template <>
+		struct StringToType<"zeroblob">
+		{
+			using type = ZeroBlob;
+		};
+
+		// Note: View types point into the column buffer of the statement and are valid until the next step.
+		template <>
+		struct StringToType<"ansi&">
+		{
+			using type = std::string_view;
+		};
+
+		template <>
+		struct StringToType<"text&">
+		{
+			using type = std::u8string_view;
+		};
+
+		template <>
+		struct StringToType<"blob&">
+		{
+			using type = BlobView;
+		};
+
 		template <FixedString fs>
 		using StringToType_t = typename StringToType<fs>::type;
 
@@ -151,7 +256,7 @@ namespace NDatabase
 		{
 			static constexpr auto To()
 			{
-				return FixedString{ "double" };
+				return FixedString{ "real" };
 			}
 		};
 
@@ -173,6 +278,24 @@ namespace NDatabase
 			}
 		};
 
+		template <>
+		struct TypeToString<EpochTime<std::chrono::microseconds>>
+		{
+			static constexpr auto To()
+			{
+				return FixedString{ "epoch" };
+			}
+		};
+
+		template <>
+		struct TypeToString<EpochTime<std::chrono::nanoseconds>>
+		{
+			static constexpr auto To()
+			{
+				return FixedString{ "epoch_ns" };
+			}
+		};
+
 		template <>
 		struct TypeToString<std::filesystem::path>
 		{
@@ -191,6 +314,42 @@ namespace NDatabase
 			}
 		};
 
+		template <>
+		struct TypeToString<ZeroBlob>
+		{
+			static constexpr auto To()
+			{
+				return FixedString{ "zeroblob" };
+			}
+		};
+
+		template <>
+		struct TypeToString<std::string_view>
+		{
+			static constexpr auto To()
+			{
+				return FixedString{ "ansi&" };
+			}
+		};
+
+		template <>
+		struct TypeToString<std::u8string_view>
+		{
+			static constexpr auto To()
+			{
+				return FixedString{ "text&" };
+			}
+		};
+
+		template <>
+		struct TypeToString<BlobView>
+		{
+			static constexpr auto To()
+			{
+				return FixedString{ "blob&" };
+			}
+		};
+
 		template <typename T>
 		class SqlType;
 
@@ -216,7 +375,7 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::int64_t v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::int64_t v, sqlite3_destructor_type = SQLITE_TRANSIENT)
 			{
 				auto r{ sqlite3_bind_int64(stmt, index, v) };
 
@@ -251,7 +410,7 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, int v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, int v, sqlite3_destructor_type = SQLITE_TRANSIENT)
 			{
 				auto r{ sqlite3_bind_int(stmt, index, v) };
 
@@ -286,7 +445,7 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, double v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, double v, sqlite3_destructor_type = SQLITE_TRANSIENT)
 			{
 				auto r{ sqlite3_bind_double(stmt, index, v) };
 
@@ -324,9 +483,9 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::string_view v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::string_view v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
 			{
-				auto r{ sqlite3_bind_text(stmt, index, std::data(v), static_cast<int>(std::size(v)), SQLITE_TRANSIENT) };
+				auto r{ sqlite3_bind_text(stmt, index, std::data(v), static_cast<int>(std::size(v)), lifetime) };
 
 				return r == SQLITE_OK;
 			}
@@ -337,6 +496,44 @@ namespace NDatabase
 			}
 		};
 
+		template <>
+		class SqlType<std::u8string_view>
+		{
+		public:
+			inline static bool ReadRowInto(sqlite3_stmt* stmt, int index, std::u8string_view& v)
+			{
+				if (auto type{ sqlite3_column_type(stmt, index) }; type == SQLITE_TEXT)
+				{
+					auto ptr{ reinterpret_cast<char8_t const*>(sqlite3_column_text(stmt, index)) };
+					auto length{ static_cast<std::size_t>(sqlite3_column_bytes(stmt, index)) };
+
+					v = std::u8string_view{ ptr, ptr ? length : 0 };
+
+					return true;
+				}
+				else if (type == SQLITE_NULL)
+				{
+					return false;
+				}
+				else
+				{
+					return false;
+				}
+			}
+
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::u8string_view v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
+			{
+				auto r{ sqlite3_bind_text(stmt, index, reinterpret_cast<char const*>(std::data(v)), static_cast<int>(std::size(v)), lifetime) };
+
+				return r == SQLITE_OK;
+			}
+
+			inline static auto ToConcrete(std::u8string_view const& v)
+			{
+				return std::u8string{ v };
+			}
+		};
+
 		template <>
 		class SqlType<std::string>
 		{
@@ -350,7 +547,7 @@ namespace NDatabase
 
 					if (ptr)
 					{
-						v = std::string{ ptr, length / sizeof(std::string::value_type) };
+						v.assign(ptr, length / sizeof(std::string::value_type));
 					}
 					else
 					{
@@ -369,9 +566,9 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::string v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::string const& v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
 			{
-				auto r{ sqlite3_bind_text(stmt, index, std::data(v), static_cast<int>(std::size(v)) * sizeof(std::string::value_type), SQLITE_TRANSIENT) };
+				auto r{ sqlite3_bind_text(stmt, index, std::data(v), static_cast<int>(std::size(v)) * sizeof(std::string::value_type), lifetime) };
 
 				return r == SQLITE_OK;
 			}
@@ -400,7 +597,7 @@ namespace NDatabase
 
 					if (ptr)
 					{
-						v = std::u8string{ reinterpret_cast<char8_t const*>(ptr), length / sizeof(std::u8string::value_type) };
+						v.assign(reinterpret_cast<char8_t const*>(ptr), length / sizeof(std::u8string::value_type));
 					}
 					else
 					{
@@ -419,9 +616,9 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::u8string v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::u8string const& v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
 			{
-				auto r{ sqlite3_bind_text(stmt, index, reinterpret_cast<char const *>(v.c_str()), static_cast<int>(std::size(v)) * sizeof(std::u8string::value_type), SQLITE_TRANSIENT) };
+				auto r{ sqlite3_bind_text(stmt, index, reinterpret_cast<char const *>(v.c_str()), static_cast<int>(std::size(v)) * sizeof(std::u8string::value_type), lifetime) };
 
 				return r == SQLITE_OK;
 			}
@@ -445,7 +642,7 @@ namespace NDatabase
 
 					if (ptr)
 					{
-						v = std::wstring{ reinterpret_cast<wchar_t const*>(ptr), length / sizeof(std::wstring::value_type) };
+						v.assign(reinterpret_cast<wchar_t const*>(ptr), length / sizeof(std::wstring::value_type));
 					}
 					else
 					{
@@ -464,9 +661,9 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::wstring v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::wstring const& v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
 			{
-				auto r{ sqlite3_bind_text(stmt, index, reinterpret_cast<char const*>(v.c_str()), static_cast<int>(std::size(v)) * sizeof(std::wstring::value_type), SQLITE_TRANSIENT) };
+				auto r{ sqlite3_bind_text(stmt, index, reinterpret_cast<char const*>(v.c_str()), static_cast<int>(std::size(v)) * sizeof(std::wstring::value_type), lifetime) };
 
 				return r == SQLITE_OK;
 			}
@@ -490,7 +687,7 @@ namespace NDatabase
 
 					if (ptr)
 					{
-						v = std::u16string{ reinterpret_cast<char16_t const*>(ptr), length / sizeof(std::u16string::value_type)};
+						v.assign(reinterpret_cast<char16_t const*>(ptr), length / sizeof(std::u16string::value_type));
 					}
 					else
 					{
@@ -509,9 +706,9 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::u16string v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::u16string const& v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
 			{
-				auto r{ sqlite3_bind_text(stmt, index, reinterpret_cast<char const*>(v.c_str()), static_cast<int>(std::size(v)) * sizeof(std::u16string::value_type), SQLITE_TRANSIENT) };
+				auto r{ sqlite3_bind_text(stmt, index, reinterpret_cast<char const*>(v.c_str()), static_cast<int>(std::size(v)) * sizeof(std::u16string::value_type), lifetime) };
 
 				return r == SQLITE_OK;
 			}
@@ -522,6 +719,140 @@ namespace NDatabase
 			}
 		};
 
+		// Enough for a signed five digit year and nine fraction digits.
+		inline constexpr std::size_t iso8601_buffer_size{ 40 };
+
+		// Writes v as "YYYY-MM-DD HH:MM:SS[.fraction]", the layout of std::format("{}", v), with as many
+		// fraction digits as Duration has. Returns the number of characters written.
+		template <typename Duration>
+		std::size_t FormatIso8601(std::chrono::time_point<std::chrono::system_clock, Duration> v, char* out)
+		{
+			auto const dp{ std::chrono::floor<std::chrono::days>(v) };
+			std::chrono::year_month_day const ymd{ dp };
+			std::chrono::hh_mm_ss const hms{ v - dp };
+			auto p{ out };
+			auto put{ [&p](long long value, int width) {
+				for (auto i{ width - 1 }; i >= 0; --i)
+				{
+					p[i] = static_cast<char>('0' + value % 10);
+					value /= 10;
+				}
+
+				p += width;
+			} };
+			auto year{ static_cast<int>(ymd.year()) };
+
+			if (year < 0)
+			{
+				*p++ = '-';
+				year = -year;
+			}
+
+			put(year, year > 9999 ? 5 : 4);
+			*p++ = '-';
+			put(static_cast<unsigned>(ymd.month()), 2);
+			*p++ = '-';
+			put(static_cast<unsigned>(ymd.day()), 2);
+			*p++ = ' ';
+			put(hms.hours().count(), 2);
+			*p++ = ':';
+			put(hms.minutes().count(), 2);
+			*p++ = ':';
+			put(hms.seconds().count(), 2);
+
+			if constexpr (decltype(hms)::fractional_width > 0)
+			{
+				*p++ = '.';
+				put(hms.subseconds().count(), decltype(hms)::fractional_width);
+			}
+
+			return static_cast<std::size_t>(p - out);
+		}
+
+		// Parses "YYYY-MM-DD[ T]HH:MM:SS[.fraction]" as written by FormatIso8601. Anything after that is ignored,
+		// as it was by std::chrono::parse("%F %T").
+		// Note: Fraction digits beyond nanoseconds are truncated.
+		template <typename Duration>
+		bool ParseIso8601(std::string_view s, std::chrono::time_point<std::chrono::system_clock, Duration>& v)
+		{
+			std::size_t pos{};
+			auto is_digit{ [&] {
+				return pos < std::size(s) && '0' <= s[pos] && s[pos] <= '9';
+			} };
+			auto digits{ [&](std::size_t count, int& value) {
+				value = 0;
+
+				for (std::size_t i{}; i != count; ++i, ++pos)
+				{
+					if (!is_digit())
+					{
+						return false;
+					}
+
+					value = value * 10 + (s[pos] - '0');
+				}
+
+				return true;
+			} };
+			auto literal{ [&](char c) {
+				if (pos < std::size(s) && s[pos] == c)
+				{
+					++pos;
+
+					return true;
+				}
+
+				return false;
+			} };
+			auto negative{ literal('-') };
+			int year, month, day, hours, minutes, seconds;
+
+			if (!digits(4, year))
+			{
+				return false;
+			}
+
+			if (is_digit())
+			{
+				year = year * 10 + (s[pos++] - '0');
+			}
+
+			if (!(literal('-') && digits(2, month) && literal('-') && digits(2, day)
+				&& (literal(' ') || literal('T'))
+				&& digits(2, hours) && literal(':') && digits(2, minutes) && literal(':') && digits(2, seconds)))
+			{
+				return false;
+			}
+
+			std::chrono::year_month_day const ymd{ std::chrono::year{ negative ? -year : year }, std::chrono::month{ static_cast<unsigned>(month) }, std::chrono::day{ static_cast<unsigned>(day) } };
+
+			if (!ymd.ok() || hours > 23 || minutes > 59 || seconds > 60)
+			{
+				return false;
+			}
+
+			std::int64_t nanoseconds{};
+
+			if (literal('.'))
+			{
+				std::int64_t scale{ 1'000'000'000 };
+
+				for (; is_digit(); ++pos)
+				{
+					if (scale > 1)
+					{
+						scale /= 10;
+						nanoseconds += (s[pos] - '0') * scale;
+					}
+				}
+			}
+
+			v = std::chrono::floor<Duration>(std::chrono::sys_days{ ymd } + std::chrono::hours{ hours } + std::chrono::minutes{ minutes } + std::chrono::seconds{ seconds })
+				+ std::chrono::floor<Duration>(std::chrono::nanoseconds{ nanoseconds });
+
+			return true;
+		}
+
 		template <>
 		class SqlType<std::chrono::system_clock::time_point>
 		{
@@ -533,10 +864,42 @@ namespace NDatabase
 					auto ptr{ reinterpret_cast<char const*>(sqlite3_column_text(stmt, index)) };
 					auto length{ static_cast<std::size_t>(sqlite3_column_bytes(stmt, index)) };
 
-					if (ptr)
-					{
-						std::istringstream{ ptr } >> std::chrono::parse("%F %T", v);
-					}
+					return ptr && ParseIso8601(std::string_view{ ptr, length }, v);
+				}
+				else if (type == SQLITE_NULL)
+				{
+					return false;
+				}
+				else
+				{
+					return false;
+				}
+			}
+
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::chrono::system_clock::time_point v, sqlite3_destructor_type = SQLITE_TRANSIENT)
+			{
+				char buffer[iso8601_buffer_size];
+				auto length{ FormatIso8601(v, buffer) };
+				auto r{ sqlite3_bind_text(stmt, index, buffer, static_cast<int>(length), SQLITE_TRANSIENT) };
+
+				return r == SQLITE_OK;
+			}
+
+			inline static auto ToConcrete(std::chrono::system_clock::time_point const& v)
+			{
+				return v;
+			}
+		};
+
+		template <typename Duration>
+		class SqlType<EpochTime<Duration>>
+		{
+		public:
+			inline static bool ReadRowInto(sqlite3_stmt* stmt, int index, EpochTime<Duration>& v)
+			{
+				if (auto type{ sqlite3_column_type(stmt, index) }; type == SQLITE_INTEGER)
+				{
+					v = EpochTime<Duration>{ Duration{ sqlite3_column_int64(stmt, index) } };
 
 					return true;
 				}
@@ -550,15 +913,14 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::chrono::system_clock::time_point v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, EpochTime<Duration> v, sqlite3_destructor_type = SQLITE_TRANSIENT)
 			{
-				auto str{ std::format("{}", v) };
-				auto r{ sqlite3_bind_text(stmt, index, str.c_str(), static_cast<int>(std::size(str)), SQLITE_TRANSIENT) };
+				auto r{ sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(v.time_since_epoch().count())) };
 
 				return r == SQLITE_OK;
 			}
 
-			inline static auto ToConcrete(std::chrono::system_clock::time_point const& v)
+			inline static auto ToConcrete(EpochTime<Duration> const& v)
 			{
 				return v;
 			}
@@ -586,7 +948,7 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, bool v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, bool v, sqlite3_destructor_type = SQLITE_TRANSIENT)
 			{
 				auto r{ sqlite3_bind_int(stmt, index, static_cast<int>(v)) };
 
@@ -631,7 +993,7 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::filesystem::path v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::filesystem::path const& v, sqlite3_destructor_type = SQLITE_TRANSIENT)
 			{
 				auto str{ v.u8string() };
 				auto r{ sqlite3_bind_text(stmt, index, reinterpret_cast<char const*>(str.c_str()), static_cast<int>(std::size(str)) * sizeof(typename decltype(str)::value_type), SQLITE_TRANSIENT)};
@@ -658,9 +1020,7 @@ namespace NDatabase
 
 					if (ptr)
 					{
-						std::span<unsigned char const> s{ ptr, length };
-
-						std::ranges::copy(s, std::back_inserter(v));
+						v.assign(ptr, ptr + length);
 					}
 					else
 					{
@@ -679,9 +1039,9 @@ namespace NDatabase
 				}
 			}
 
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::vector<unsigned char> v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::vector<unsigned char> const& v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
 			{
-				auto r{ sqlite3_bind_blob(stmt, index, std::data(v), static_cast<int>(std::ssize(v)), SQLITE_TRANSIENT) };
+				auto r{ sqlite3_bind_blob(stmt, index, std::data(v), static_cast<int>(std::ssize(v)), lifetime) };
 
 				return r == SQLITE_OK;
 			}
@@ -692,43 +1052,115 @@ namespace NDatabase
 			}
 		};
 
-		template <typename T>
-		class SqlType<std::optional<T>>
+		template <>
+		class SqlType<BlobView>
 		{
 		public:
-			template <typename T>
-			inline static bool ReadRowInto(sqlite3_stmt* stmt, int index, std::optional<T>& v)
+			inline static bool ReadRowInto(sqlite3_stmt* stmt, int index, BlobView& v)
 			{
-				if (auto type{ sqlite3_column_type(stmt, index) }; type == SQLITE_NULL)
+				if (auto type{ sqlite3_column_type(stmt, index) }; type == SQLITE_BLOB)
 				{
-					v = std::nullopt;
+					auto ptr{ reinterpret_cast<unsigned char const*>(sqlite3_column_blob(stmt, index)) };
+					auto length{ static_cast<std::size_t>(sqlite3_column_bytes(stmt, index)) };
+
+					v = BlobView{ ptr, ptr ? length : 0 };
 
 					return true;
 				}
+				else if (type == SQLITE_NULL)
+				{
+					return false;
+				}
 				else
 				{
-					v.emplace();
-
-					return SqlType<T>::ReadRowInto(stmt, index, *v);
+					return false;
 				}
 			}
 
-			template <typename T>
-			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::optional<T> const& v)
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, BlobView v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
 			{
-				if (v.has_value())
+				auto r{ sqlite3_bind_blob(stmt, index, std::data(v), static_cast<int>(std::size(v)), lifetime) };
+
+				return r == SQLITE_OK;
+			}
+
+			inline static auto ToConcrete(BlobView const& v)
+			{
+				return std::vector<unsigned char>{ std::begin(v), std::end(v) };
+			}
+		};
+
+		template <>
+		class SqlType<ZeroBlob>
+		{
+		public:
+			inline static bool ReadRowInto(sqlite3_stmt* stmt, int index, ZeroBlob& v)
+			{
+				if (auto type{ sqlite3_column_type(stmt, index) }; type == SQLITE_BLOB)
 				{
-					return SqlType<T>::BindImpl(stmt, index, *v);
+					v.size = static_cast<std::uint64_t>(sqlite3_column_bytes(stmt, index));
+
+					return true;
 				}
 				else
 				{
-					auto r{ sqlite3_bind_null(stmt, index) };
-
-					return r == SQLITE_OK;
+					return false;
 				}
 			}
 
-			template <typename T>
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, ZeroBlob v, sqlite3_destructor_type = SQLITE_TRANSIENT)
+			{
+				auto r{ sqlite3_bind_zeroblob64(stmt, index, v.size) };
+
+				return r == SQLITE_OK;
+			}
+
+			inline static auto ToConcrete(ZeroBlob const& v)
+			{
+				return v;
+			}
+		};
+
+		template <typename T>
+		class SqlType<std::optional<T>>
+		{
+		public:
+			template <typename T>
+			inline static bool ReadRowInto(sqlite3_stmt* stmt, int index, std::optional<T>& v)
+			{
+				if (auto type{ sqlite3_column_type(stmt, index) }; type == SQLITE_NULL)
+				{
+					v = std::nullopt;
+
+					return true;
+				}
+				else
+				{
+					if (!v)
+					{
+						v.emplace();
+					}
+
+					return SqlType<T>::ReadRowInto(stmt, index, *v);
+				}
+			}
+
+			template <typename T>
+			inline static bool BindImpl(sqlite3_stmt* stmt, int index, std::optional<T> const& v, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
+			{
+				if (v.has_value())
+				{
+					return SqlType<T>::BindImpl(stmt, index, *v, lifetime);
+				}
+				else
+				{
+					auto r{ sqlite3_bind_null(stmt, index) };
+
+					return r == SQLITE_OK;
+				}
+			}
+
+			template <typename T>
 			inline static auto ToConcrete(std::optional<T> const& o) -> std::optional<decltype(SqlType<T>::ToConcrete(std::declval<T>()))>
 			{
 				if (!o)
@@ -755,7 +1187,15 @@ namespace NDatabase
 			}
 		};
 
-		template <FixedString name, typename T, FixedString type_description = "NOT NULL">
+		// Index that SQLite3Manager::Create builds for a column, named "<table>_<column>".
+		enum class IndexKind
+		{
+			None,
+			Index,
+			Unique,
+		};
+
+		template <FixedString name, typename T, FixedString type_description = "NOT NULL", IndexKind index_kind = IndexKind::None>
 		class NameAndType
 		{
 			static_assert(type_description.contains<"NOT NULL"_fs>(), "type_description must include \"NOT NULL\"");
@@ -767,6 +1207,11 @@ namespace NDatabase
 				return name;
 			}
 
+			constexpr IndexKind Indexed() const
+			{
+				return index_kind;
+			}
+
 			constexpr auto operator()() const
 			{
 				return name;
@@ -792,8 +1237,8 @@ namespace NDatabase
 			}
 		};
 
-		template <FixedString name, typename T, FixedString type_description>
-		class NameAndType<name, std::optional<T>, type_description>
+		template <FixedString name, typename T, FixedString type_description, IndexKind index_kind>
+		class NameAndType<name, std::optional<T>, type_description, index_kind>
 		{
 		public:
 			using value_type = std::optional<T>;
@@ -803,6 +1248,11 @@ namespace NDatabase
 				return name;
 			}
 
+			constexpr IndexKind Indexed() const
+			{
+				return index_kind;
+			}
+
 			constexpr auto Decl() const
 			{
 				using namespace NDataStructure::Literals;
@@ -850,11 +1300,10 @@ namespace NDatabase
 		}
 
 		template <typename RowType>
-		auto ReadRow(sqlite3_stmt* stmt)
+		void CheckColumnCount(sqlite3_stmt* stmt)
 		{
-			RowType row{};
 			std::size_t count{ static_cast<std::size_t>(sqlite3_column_count(stmt)) };
-			auto length{ std::size(row) };
+			auto length{ RowType::size() };
 
 			assert(length == count);
 
@@ -862,26 +1311,212 @@ namespace NDatabase
 			{
 				throw std::runtime_error{ "sqlite error: mismatch between read_row and sql columns" };
 			}
+		}
 
+		// Reads the current row into row, reusing the capacity of its strings and vectors.
+		// Note: The column count is checked once when the statement is prepared.
+		template <typename RowType>
+		void ReadRowInto(sqlite3_stmt* stmt, RowType& row)
+		{
 			auto index{ 0 };
 
 			row.ForEach([&](auto& m) mutable {
-				SqlType<std::remove_cvref_t<decltype(m.Value())>>::ReadRowInto(stmt, index, m.Value());
+				using T = std::remove_cvref_t<decltype(m.Value())>;
+
+				if (!SqlType<T>::ReadRowInto(stmt, index, m.Value()))
+				{
+					m.Value() = T{};
+				}
+
 				++index;
 			});
+		}
+
+		template <typename RowType>
+		auto ReadRow(sqlite3_stmt* stmt)
+		{
+			RowType row{};
+
+			CheckColumnCount<RowType>(stmt);
+			ReadRowInto(stmt, row);
 
 			return row;
 		}
 
+		// Latency distribution in power of two buckets: bucket i counts durations of [2^(i - 1), 2^i) nanoseconds.
+		struct LatencyHistogram
+		{
+			static constexpr std::size_t bucket_count{ 48 };
+
+			std::array<std::uint64_t, bucket_count> buckets{};
+			std::uint64_t count{};
+			std::chrono::nanoseconds total{};
+			std::chrono::nanoseconds max{};
+
+			void Record(std::chrono::nanoseconds d)
+			{
+				auto const ns{ static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(d.count(), 0)) };
+
+				++buckets[std::min<std::size_t>(std::bit_width(ns), bucket_count - 1)];
+				++count;
+				total += d;
+				max = std::max(max, d);
+			}
+
+			std::chrono::nanoseconds Mean() const
+			{
+				return count == 0 ? std::chrono::nanoseconds{} : total / static_cast<std::chrono::nanoseconds::rep>(count);
+			}
+
+			// Upper bound of the bucket holding the p-th fraction of the samples, e.g. Percentile(0.99).
+			std::chrono::nanoseconds Percentile(double p) const
+			{
+				auto const rank{ std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(p * count)), 1) };
+				std::uint64_t seen{};
+
+				for (std::size_t i{}; i != bucket_count; ++i)
+				{
+					seen += buckets[i];
+
+					if (seen >= rank)
+					{
+						return std::min(std::chrono::nanoseconds{ (std::int64_t{ 1 } << i) - 1 }, max);
+					}
+				}
+
+				return max;
+			}
+
+			void Merge(LatencyHistogram const& other)
+			{
+				for (std::size_t i{}; i != bucket_count; ++i)
+				{
+					buckets[i] += other.buckets[i];
+				}
+
+				count += other.count;
+				total += other.total;
+				max = std::max(max, other.max);
+			}
+		};
+
+		// What one query has cost on a connection, filled in by every profiled PreparedStatement of that query.
+		struct StatementStatistics
+		{
+			std::string query;
+			std::uint64_t prepares{};
+			std::chrono::nanoseconds prepare_time{};
+			std::uint64_t cache_hits{};
+			std::uint64_t executions{};			// SQLITE_STMTSTATUS_RUN
+			LatencyHistogram execute_latency;	// Whole Execute, ExecuteSingleRow, ExecuteInto and ExecuteBatch calls
+			LatencyHistogram step_latency;		// Every sqlite3_step
+			std::uint64_t rows{};
+			std::uint64_t bytes_bound{};
+			std::uint64_t bytes_read{};
+			std::uint64_t full_scan_steps{};	// SQLITE_STMTSTATUS_FULLSCAN_STEP
+			std::uint64_t sorts{};				// SQLITE_STMTSTATUS_SORT
+			std::uint64_t autoindex{};			// SQLITE_STMTSTATUS_AUTOINDEX
+			std::uint64_t vm_steps{};			// SQLITE_STMTSTATUS_VM_STEP
+
+			// Adds the sqlite3_stmt_status counters of stmt and resets them.
+			void Collect(sqlite3_stmt* stmt)
+			{
+				executions += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_RUN, 1);
+				full_scan_steps += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+				sorts += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+				autoindex += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+				vm_steps += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 1);
+			}
+
+			// Adds the counters of other, which was filled in on another thread, e.g. by a PipelinedRows producer.
+			void Merge(StatementStatistics const& other)
+			{
+				prepares += other.prepares;
+				prepare_time += other.prepare_time;
+				cache_hits += other.cache_hits;
+				executions += other.executions;
+				execute_latency.Merge(other.execute_latency);
+				step_latency.Merge(other.step_latency);
+				rows += other.rows;
+				bytes_bound += other.bytes_bound;
+				bytes_read += other.bytes_read;
+				full_scan_steps += other.full_scan_steps;
+				sorts += other.sorts;
+				autoindex += other.autoindex;
+				vm_steps += other.vm_steps;
+			}
+		};
+
+		// sqlite3_step, timed and counted into statistics when the statement is profiled.
+		inline int Step(sqlite3_stmt* stmt, StatementStatistics* statistics)
+		{
+			if (!statistics)
+			{
+				return sqlite3_step(stmt);
+			}
+
+			auto const begin{ std::chrono::steady_clock::now() };
+			auto const r{ sqlite3_step(stmt) };
+
+			statistics->step_latency.Record(std::chrono::steady_clock::now() - begin);
+
+			if (r == SQLITE_ROW)
+			{
+				++statistics->rows;
+
+				for (int i{}, count{ sqlite3_column_count(stmt) }; i != count; ++i)
+				{
+					// Note: sqlite3_column_bytes would convert numbers to text, so they count as 8 bytes.
+					if (auto type{ sqlite3_column_type(stmt, i) }; type == SQLITE_TEXT || type == SQLITE_BLOB)
+					{
+						statistics->bytes_read += static_cast<std::uint64_t>(sqlite3_column_bytes(stmt, i));
+					}
+					else if (type != SQLITE_NULL)
+					{
+						statistics->bytes_read += 8;
+					}
+				}
+			}
+
+			return r;
+		}
+
+		// Records its own lifetime into statistics->execute_latency.
+		class ExecutionTimer final
+		{
+		public:
+			explicit ExecutionTimer(StatementStatistics* statistics)
+				: statistics{ statistics }, begin{ statistics ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{} }
+			{
+				// Nothing
+			}
+
+			ExecutionTimer(ExecutionTimer const&) = delete;
+			ExecutionTimer& operator=(ExecutionTimer const&) = delete;
+
+			~ExecutionTimer()
+			{
+				if (statistics)
+				{
+					statistics->execute_latency.Record(std::chrono::steady_clock::now() - begin);
+				}
+			}
+
+		private:
+			StatementStatistics* statistics;
+			std::chrono::steady_clock::time_point begin;
+		};
+
 		template <typename RowType>
 		struct RowRange
 		{
 			RowType row;
 			int last_result{};
 			sqlite3_stmt* stmt;
+			StatementStatistics* statistics;
 
-			RowRange(sqlite3_stmt* stmt)
-				: stmt{ stmt }
+			RowRange(sqlite3_stmt* stmt, StatementStatistics* statistics = nullptr)
+				: stmt{ stmt }, statistics{ statistics }
 			{
 				Next();
 			}
@@ -898,9 +1533,14 @@ namespace NDatabase
 
 			void Next()
 			{
-				last_result = sqlite3_step(stmt);
+				last_result = Step(stmt, statistics);
 
 				CheckSqliteReturn(last_result, SQLITE_DONE, SQLITE_ROW);
+
+				if (last_result == SQLITE_ROW)
+				{
+					ReadRowInto(stmt, row);
+				}
 			}
 
 			struct RowIterator
@@ -926,8 +1566,6 @@ namespace NDatabase
 
 				RowType& operator*()
 				{
-					p->row = ReadRow<RowType>(p->stmt);
-
 					return p->row;
 				}
 			};
@@ -943,115 +1581,425 @@ namespace NDatabase
 			}
 		};
 
+		// Decodes the current row straight into the column vectors of rows.
+		// Note: If a column fails to decode, the partially appended row is removed before rethrowing.
 		template <auto... Tags, typename... Ts, auto... Init>
-		auto ToConcrete(NDataStructure::TaggedTuple<NDataStructure::Member<Tags, Ts, Init>...> const& t)
-		{
-			return NDataStructure::TaggedTuple{ (NDataStructure::tag<Tags> 
-				= SqlType<std::remove_cvref_t<decltype(NDataStructure::Get<Tags>(t))>>::ToConcrete(NDataStructure::Get<Tags>(t)))...};
-		}
-
-		template <auto... Tags, typename... Ts, auto... Init>
-		auto ToConcrete(NDataStructure::TaggedTuple<NDataStructure::Member<Tags, Ts, Init>...>&& t)
+		void AppendRowInto(sqlite3_stmt* stmt, NDataStructure::SoaVector<NDataStructure::TaggedTuple<NDataStructure::Member<Tags, Ts, Init>...>>& rows)
 		{
-			return NDataStructure::TaggedTuple{ (NDataStructure::tag<Tags> 
-				= SqlType<std::remove_cvref_t<decltype(NDataStructure::Get<Tags>(std::move(t)))>>::ToConcrete(NDataStructure::Get<Tags>(std::move(t))))... };
-		}	
+			auto const size{ std::size(rows) };
+			auto index{ 0 };
 
-		template <bool make_optional, typename Tag, typename T, auto Init>
-		constexpr auto MaybeMakeOptional(NDataStructure::InternalTaggedTuple::MemberImpl<Tag, T, Init> m)
-		{
-			if constexpr (make_optional)
+			try
 			{
-				return NDataStructure::InternalTaggedTuple::MemberImpl<Tag, std::optional<T>, Init>{ std::nullopt };
+				([&] {
+					auto& value{ NDataStructure::Get<Tags>(rows.Vectors()).emplace_back() };
+
+					SqlType<std::remove_cvref_t<decltype(value)>>::ReadRowInto(stmt, index, value);
+					++index;
+				}(), ...);
 			}
-			else
+			catch (...)
 			{
-				return m;
+				(NDataStructure::Get<Tags>(rows.Vectors()).resize(size), ...);
+
+				throw;
 			}
 		}
 
-		constexpr std::string_view start_group{ "{{" };
-		constexpr std::string_view end_group{ "}}" };
-
-		constexpr std::string_view delimiters{ ", ();" };
-		constexpr std::string_view quotes{ "\"\'" };
-
-		struct TypeSpecsCount
+		// Steps the statement batch_size rows at a time. Each batch reuses the column storage of the previous one,
+		// so a batch must be consumed (or moved out) before advancing.
+		template <typename Batch>
+		struct BatchRange
 		{
-			std::size_t fields;
-			std::size_t params;
+			Batch batch;
+			std::size_t batch_size;
+			int last_result{};
+			sqlite3_stmt* stmt;
+			StatementStatistics* statistics;
 
-			constexpr auto operator<=>(TypeSpecsCount const&) const = default;
-		};
+			BatchRange(sqlite3_stmt* stmt, std::size_t batch_size, StatementStatistics* statistics = nullptr)
+				: batch_size{ std::max<std::size_t>(batch_size, 1) }, stmt{ stmt }, statistics{ statistics }
+			{
+				batch.reserve(this->batch_size);
+				Next();
+			}
 
-		inline constexpr std::string_view start_comment{ "/*:" };
-		inline constexpr std::string_view end_comment{ "*/" };
+			struct EndType
+			{
+				// Nothing
+			};
 
-		template <FixedString query_string>
-		constexpr auto GetTypeSpecCount()
-		{
-			constexpr auto sv{ query_string.ToStringView() };
-			TypeSpecsCount count{};
-			std::string_view str{ sv };
+			EndType end()
+			{
+				return {};
+			}
 
-			while (!std::empty(str))
+			void Next()
 			{
-				auto pos{ str.find(start_comment) };
+				batch.clear();
 
-				if (pos == str.npos)
+				// Note: Stepping again after SQLITE_DONE would restart the statement.
+				while (last_result != SQLITE_DONE && std::size(batch) < batch_size)
 				{
-					break;
+					last_result = Step(stmt, statistics);
+
+					CheckSqliteReturn(last_result, SQLITE_DONE, SQLITE_ROW);
+
+					if (last_result == SQLITE_ROW)
+					{
+						AppendRowInto(stmt, batch);
+					}
 				}
+			}
 
-				pos += std::size(start_comment);
-				str = str.substr(pos);
-				pos = str.find(end_comment);
+			struct BatchIterator
+			{
+				BatchRange* p;
 
-				if (pos == str.npos)
+				BatchIterator& operator++()
 				{
-					break;
+					p->Next();
+
+					return *this;
 				}
 
-				if (auto comment{ str.substr(0, pos) }; comment.find(":") == comment.npos)
+				bool operator!=(EndType)
 				{
-					++count.fields;
+					return !std::empty(p->batch);
 				}
-				else
+
+				bool operator==(EndType)
 				{
-					++count.params;
+					return std::empty(p->batch);
 				}
-			}
-
-			return count;
-		}
 
-		template <typename First, typename Second>
-		struct Pair
-		{
-			First first;
-			Second second;
+				Batch& operator*()
+				{
+					return p->batch;
+				}
+			};
 
-			constexpr auto operator<=>(Pair const&) const = default;
+			BatchIterator begin()
+			{
+				return { this };
+			}
 		};
 
-		struct TypeSpec
+		// Steps stmt on a producer thread into a ring of batch_count batches of up to batch_size rows,
+		// while the consuming thread iterates the batches already decoded.
+		// Note: The producer waits while every batch is still held by the consumer, and stops at the next row
+		// once Cancel() is called or the range is destroyed. The statement must not be used until then.
+		// The producer counts steps into its own statistics, which are added to statistics when the range is destroyed.
+		template <typename Batch>
+		class PipelinedRows final
 		{
-			Pair<std::size_t, std::size_t> name;
-			Pair<std::size_t, std::size_t> type;
-			bool optional;
+		public:
+			PipelinedRows(sqlite3_stmt* stmt, std::size_t batch_size, std::size_t batch_count, StatementStatistics* statistics = nullptr)
+				: batches(std::max<std::size_t>(batch_count, 1)), batch_size{ std::max<std::size_t>(batch_size, 1) }, statistics{ statistics }
+			{
+				for (auto& batch : batches)
+				{
+					batch.reserve(this->batch_size);
+				}
 
-			constexpr auto operator<=>(TypeSpec const&) const = default;
-		};
+				producer = std::thread{ [this, stmt] {
+					Produce(stmt, this->statistics ? &produced : nullptr);
+				} };
+			}
 
-		template <std::size_t N>
-		struct TypeSpecs
-		{
-			constexpr auto operator<=>(TypeSpecs const&) const = default;
-			TypeSpec data[N];
+			PipelinedRows(PipelinedRows const&) = delete;
+			PipelinedRows& operator=(PipelinedRows const&) = delete;
 
-			static constexpr std::size_t size()
+			~PipelinedRows()
 			{
-				return N;
+				Cancel();
+				producer.join();
+
+				if (statistics)
+				{
+					statistics->Merge(produced);
+				}
+			}
+
+			void Cancel()
+			{
+				{
+					std::lock_guard lock{ mutex };
+
+					cancelled = true;
+				}
+
+				changed.notify_all();
+			}
+
+			struct EndType
+			{
+				// Nothing
+			};
+
+			EndType end()
+			{
+				return {};
+			}
+
+			struct BatchIterator
+			{
+				PipelinedRows* p;
+
+				BatchIterator& operator++()
+				{
+					p->Release();
+					p->Acquire();
+
+					return *this;
+				}
+
+				bool operator!=(EndType)
+				{
+					return p->current != nullptr;
+				}
+
+				bool operator==(EndType)
+				{
+					return p->current == nullptr;
+				}
+
+				Batch const& operator*()
+				{
+					return *p->current;
+				}
+			};
+
+			// Note: Rethrows the error that stopped the producer once the batches before it are consumed.
+			BatchIterator begin()
+			{
+				Acquire();
+
+				return { this };
+			}
+
+		private:
+			void Produce(sqlite3_stmt* stmt, StatementStatistics* statistics)
+			{
+				try
+				{
+					auto r{ SQLITE_ROW };
+
+					while (r == SQLITE_ROW)
+					{
+						Batch* batch;
+
+						{
+							std::unique_lock lock{ mutex };
+
+							changed.wait(lock, [this] {
+								return cancelled || tail - head < std::size(batches);
+							});
+
+							if (cancelled)
+							{
+								break;
+							}
+
+							batch = &batches[tail % std::size(batches)];
+						}
+
+						// Note: The slot at tail is not visible to the consumer until tail is advanced.
+						batch->clear();
+
+						while (std::size(*batch) < batch_size && !cancelled.load(std::memory_order_relaxed) && (r = Step(stmt, statistics)) == SQLITE_ROW)
+						{
+							AppendRowInto(stmt, *batch);
+						}
+
+						CheckSqliteReturn(r, SQLITE_DONE, SQLITE_ROW);
+
+						if (!std::empty(*batch))
+						{
+							{
+								std::lock_guard lock{ mutex };
+
+								++tail;
+							}
+
+							changed.notify_all();
+						}
+					}
+				}
+				catch (...)
+				{
+					std::lock_guard lock{ mutex };
+
+					error = std::current_exception();
+				}
+
+				{
+					std::lock_guard lock{ mutex };
+
+					finished = true;
+				}
+
+				changed.notify_all();
+			}
+
+			void Acquire()
+			{
+				std::unique_lock lock{ mutex };
+
+				changed.wait(lock, [this] {
+					return cancelled || head != tail || finished;
+				});
+
+				if (!cancelled && head != tail)
+				{
+					current = &batches[head % std::size(batches)];
+				}
+				else
+				{
+					current = nullptr;
+
+					if (auto e{ std::exchange(error, nullptr) }; e && !cancelled)
+					{
+						std::rethrow_exception(e);
+					}
+				}
+			}
+
+			void Release()
+			{
+				{
+					std::lock_guard lock{ mutex };
+
+					++head;
+				}
+
+				changed.notify_all();
+			}
+
+			std::vector<Batch> batches;
+			std::size_t batch_size;
+			std::size_t head{};	// Next batch to consume
+			std::size_t tail{};	// Next batch to fill
+			Batch const* current{ nullptr };
+			bool finished{ false };
+			std::atomic<bool> cancelled{ false };
+			std::exception_ptr error;
+			std::mutex mutex;
+			std::condition_variable changed;
+			StatementStatistics* statistics;
+			StatementStatistics produced;	// Written by the producer thread only, until it is joined
+			std::thread producer;
+		};
+
+		template <auto... Tags, typename... Ts, auto... Init>
+		auto ToConcrete(NDataStructure::TaggedTuple<NDataStructure::Member<Tags, Ts, Init>...> const& t)
+		{
+			return NDataStructure::TaggedTuple{ (NDataStructure::tag<Tags> 
+				= SqlType<std::remove_cvref_t<decltype(NDataStructure::Get<Tags>(t))>>::ToConcrete(NDataStructure::Get<Tags>(t)))...};
+		}
+
+		template <auto... Tags, typename... Ts, auto... Init>
+		auto ToConcrete(NDataStructure::TaggedTuple<NDataStructure::Member<Tags, Ts, Init>...>&& t)
+		{
+			return NDataStructure::TaggedTuple{ (NDataStructure::tag<Tags> 
+				= SqlType<std::remove_cvref_t<decltype(NDataStructure::Get<Tags>(std::move(t)))>>::ToConcrete(NDataStructure::Get<Tags>(std::move(t))))... };
+		}	
+
+		template <bool make_optional, typename Tag, typename T, auto Init>
+		constexpr auto MaybeMakeOptional(NDataStructure::InternalTaggedTuple::MemberImpl<Tag, T, Init> m)
+		{
+			if constexpr (make_optional)
+			{
+				return NDataStructure::InternalTaggedTuple::MemberImpl<Tag, std::optional<T>, Init>{ std::nullopt };
+			}
+			else
+			{
+				return m;
+			}
+		}
+
+		constexpr std::string_view start_group{ "{{" };
+		constexpr std::string_view end_group{ "}}" };
+
+		constexpr std::string_view delimiters{ ", ();" };
+		constexpr std::string_view quotes{ "\"\'" };
+
+		struct TypeSpecsCount
+		{
+			std::size_t fields;
+			std::size_t params;
+
+			constexpr auto operator<=>(TypeSpecsCount const&) const = default;
+		};
+
+		inline constexpr std::string_view start_comment{ "/*:" };
+		inline constexpr std::string_view end_comment{ "*/" };
+
+		template <FixedString query_string>
+		constexpr auto GetTypeSpecCount()
+		{
+			constexpr auto sv{ query_string.ToStringView() };
+			TypeSpecsCount count{};
+			std::string_view str{ sv };
+
+			while (!std::empty(str))
+			{
+				auto pos{ str.find(start_comment) };
+
+				if (pos == str.npos)
+				{
+					break;
+				}
+
+				pos += std::size(start_comment);
+				str = str.substr(pos);
+				pos = str.find(end_comment);
+
+				if (pos == str.npos)
+				{
+					break;
+				}
+
+				if (auto comment{ str.substr(0, pos) }; comment.find(":") == comment.npos)
+				{
+					++count.fields;
+				}
+				else
+				{
+					++count.params;
+				}
+			}
+
+			return count;
+		}
+
+		template <typename First, typename Second>
+		struct Pair
+		{
+			First first;
+			Second second;
+
+			constexpr auto operator<=>(Pair const&) const = default;
+		};
+
+		struct TypeSpec
+		{
+			Pair<std::size_t, std::size_t> name;
+			Pair<std::size_t, std::size_t> type;
+			bool optional;
+
+			constexpr auto operator<=>(TypeSpec const&) const = default;
+		};
+
+		template <std::size_t N>
+		struct TypeSpecs
+		{
+			constexpr auto operator<=>(TypeSpecs const&) const = default;
+			TypeSpec data[N];
+
+			static constexpr std::size_t size()
+			{
+				return N;
 			}
 
 			static constexpr bool empty()
@@ -1259,185 +2207,1848 @@ namespace NDatabase
 
 		std::false_type IsOptional(...);	// has no body
 
-		template <typename PTuple>
-		void DoBinding(sqlite3_stmt* stmt, PTuple p_tuple)
-		{
-			auto index{ 1 };
+		inline void ExecuteSql(sqlite3* db, char const* sql)
+		{
+			auto r{ sqlite3_exec(db, sql, nullptr, nullptr, nullptr) };
+
+			CheckSqliteReturn(r);
+		}
+
+		inline constexpr std::size_t default_batch_chunk_size{ 1000 };
+
+		enum class TransactionMode
+		{
+			Deferred,
+			Immediate,
+			Exclusive
+		};
+
+		// Retries statements that fail with SQLITE_BUSY or SQLITE_LOCKED, doubling the delay between attempts.
+		struct BusyRetry
+		{
+			int attempts{ 20 };
+			std::chrono::milliseconds first_delay{ 1 };
+			std::chrono::milliseconds max_delay{ 100 };
+		};
+
+		// Returns the result of the last attempt.
+		inline int TryExecuteSql(sqlite3* db, char const* sql, BusyRetry const& retry)
+		{
+			auto delay{ retry.first_delay };
+
+			for (auto attempt{ 1 }; ; ++attempt)
+			{
+				auto r{ sqlite3_exec(db, sql, nullptr, nullptr, nullptr) };
+				auto const busy{ (r & 0xff) == SQLITE_BUSY || (r & 0xff) == SQLITE_LOCKED };
+
+				if (!busy || attempt >= retry.attempts)
+				{
+					return r;
+				}
+
+				std::this_thread::sleep_for(delay);
+				delay = std::min(delay * 2, retry.max_delay);
+			}
+		}
+
+		inline void ExecuteSql(sqlite3* db, char const* sql, BusyRetry const& retry)
+		{
+			CheckSqliteReturn(TryExecuteSql(db, sql, retry));
+		}
+
+		// Note: A rollback fails harmlessly when SQLite has already rolled the whole transaction back on its own
+		// (after SQLITE_FULL, SQLITE_IOERR, ...), so only a failure that leaves the transaction open is reported.
+		inline bool RollbackSql(sqlite3* db, char const* sql) noexcept
+		{
+			auto const r{ sqlite3_exec(db, sql, nullptr, nullptr, nullptr) };
+
+			if (r == SQLITE_OK || sqlite3_get_autocommit(db) != 0)
+			{
+				return true;
+			}
+
+			std::cerr << "sqlite rollback failed: " << sqlite3_errmsg(db) << '\n';
+
+			return false;
+		}
+
+		enum class ChangeKind
+		{
+			Insert,
+			Update,
+			Delete,
+		};
+
+		struct ChangeEvent
+		{
+			ChangeKind kind;
+			std::int64_t rowid;
+		};
+
+		// Row changes made through one connection, collected with sqlite3_update_hook and released per committed transaction.
+		// Note: A hook must not use its connection, so listeners are only called from Dispatch(), where they may query it,
+		// e.g. with SQLite3Manager::FetchChangedRows. Not reported: changes by other connections, WITHOUT ROWID tables,
+		// and a DELETE without WHERE, which SQLite runs as a truncate. Changes undone by ROLLBACK TO are dropped only when
+		// the savepoint was taken with a Savepoint guard that was given the feed, as SQLite3Manager::BeginSavepoint does.
+		// The feed takes the update, commit and rollback hooks of its connection over. SQLite hands back only the argument
+		// of a replaced hook, not the hook itself, so that hook can be neither chained nor restored: when one had a non-null
+		// argument, Subscribe() removes the feed's hooks again and throws, leaving the connection with none. A hook set with
+		// a null argument cannot be told apart from no hook and is taken over silently.
+		class ChangeFeed final
+		{
+		public:
+			using Listener = std::function<void(std::span<ChangeEvent const>)>;
+			using Mark = std::vector<std::size_t>;	// Pending event count of each table, in the order tables were first changed
+
+			ChangeFeed() = default;
+			ChangeFeed(ChangeFeed const&) = delete;
+			ChangeFeed& operator=(ChangeFeed const&) = delete;
+
+			// Watches table of database ("main", "temp" or an attached schema name); tables of the same name in other
+			// databases are not reported. Hooks are installed on db by the first subscription, so a connection nobody
+			// watches pays nothing. Returns the id to unsubscribe with.
+			std::size_t Subscribe(sqlite3* db, std::string database, std::string table, Listener listener)
+			{
+				if (!installed)
+				{
+					void const* const replaced[]{
+						sqlite3_update_hook(db, &ChangeFeed::OnUpdate, this),
+						sqlite3_commit_hook(db, &ChangeFeed::OnCommit, this),
+						sqlite3_rollback_hook(db, &ChangeFeed::OnRollback, this)
+					};
+
+					if (std::ranges::any_of(replaced, [](void const* context) { return context != nullptr; }))
+					{
+						sqlite3_update_hook(db, nullptr, nullptr);
+						sqlite3_commit_hook(db, nullptr, nullptr);
+						sqlite3_rollback_hook(db, nullptr, nullptr);
+
+						throw std::logic_error{ "sqlite change feed: replaced another update, commit or rollback hook" };
+					}
+
+					installed = true;
+				}
+
+				subscriptions.push_back({ ++last_id, std::move(database), std::move(table), std::move(listener) });
+
+				return last_id;
+			}
+
+			void Unsubscribe(std::size_t id)
+			{
+				std::erase_if(subscriptions, [id](auto const& s) {
+					return s.id == id;
+				});
+			}
+
+			// Calls the listeners of each table with its changes, one call per table and committed transaction, in commit order.
+			// Returns the number of events delivered.
+			// Note: Listeners must not subscribe or unsubscribe.
+			std::size_t Dispatch()
+			{
+				std::size_t delivered{};
+				auto transactions{ std::move(committed) };
+
+				committed.clear();
+
+				for (auto const& transaction : transactions)
+				{
+					for (auto const& changes : transaction)
+					{
+						for (auto const& s : subscriptions)
+						{
+							if (s.database == changes.database && s.table == changes.table)
+							{
+								s.listener(changes.events);
+							}
+						}
+
+						delivered += std::size(changes.events);
+					}
+				}
+
+				return delivered;
+			}
+
+			// Committed transactions not dispatched yet.
+			std::size_t size() const
+			{
+				return std::size(committed);
+			}
+
+			// Where the uncommitted changes end now, for RollbackTo() when a savepoint taken here is rolled back.
+			Mark PendingMark() const
+			{
+				Mark mark;
+
+				mark.reserve(std::size(pending));
+
+				for (auto const& changes : pending)
+				{
+					mark.push_back(std::size(changes.events));
+				}
+
+				return mark;
+			}
+
+			// Drops the uncommitted changes made after mark was taken.
+			void RollbackTo(Mark const& mark) noexcept
+			{
+				if (std::size(pending) > std::size(mark))
+				{
+					pending.erase(std::begin(pending) + std::size(mark), std::end(pending));
+				}
+
+				for (std::size_t i{}; i != std::size(pending); ++i)
+				{
+					auto& events{ pending[i].events };
+
+					if (std::size(events) > mark[i])
+					{
+						events.erase(std::begin(events) + mark[i], std::end(events));
+					}
+				}
+			}
+
+		private:
+			struct Subscription
+			{
+				std::size_t id;
+				std::string database;
+				std::string table;
+				Listener listener;
+			};
+
+			struct TableChanges
+			{
+				std::string database;
+				std::string table;
+				std::vector<ChangeEvent> events;
+			};
+
+			static void OnUpdate(void* context, int operation, char const* database, char const* table, sqlite3_int64 rowid)
+			{
+				auto& self{ *static_cast<ChangeFeed*>(context) };
+				std::string_view const database_name{ database };
+				std::string_view const name{ table };
+				auto const watched{ [&](auto const& s) {
+					return s.database == database_name && s.table == name;
+				} };
+
+				if (std::ranges::none_of(self.subscriptions, watched))
+				{
+					return;
+				}
+
+				auto kind{ operation == SQLITE_INSERT ? ChangeKind::Insert : operation == SQLITE_DELETE ? ChangeKind::Delete : ChangeKind::Update };
+				auto it{ std::ranges::find_if(self.pending, watched) };
+
+				if (it == std::end(self.pending))
+				{
+					it = self.pending.insert(std::end(self.pending), { std::string{ database_name }, std::string{ name }, {} });
+				}
+
+				it->events.push_back({ kind, rowid });
+			}
+
+			static int OnCommit(void* context)
+			{
+				auto& self{ *static_cast<ChangeFeed*>(context) };
+
+				if (!std::empty(self.pending))
+				{
+					self.committed.push_back(std::move(self.pending));
+					self.pending.clear();
+				}
+
+				return 0;
+			}
+
+			static void OnRollback(void* context)
+			{
+				static_cast<ChangeFeed*>(context)->pending.clear();
+			}
+
+			bool installed{ false };
+			std::size_t last_id{};
+			std::vector<Subscription> subscriptions;
+			std::vector<TableChanges> pending;
+			std::vector<std::vector<TableChanges>> committed;
+		};
+
+		// Commits on scope exit, or rolls back when the scope is left by an exception.
+		// Note: A commit failing on scope exit is rolled back and written to std::cerr, since a destructor cannot throw.
+		// Call Commit() to have the error thrown.
+		class Transaction final
+		{
+		public:
+			Transaction(sqlite3* db, TransactionMode mode, BusyRetry retry)
+				: db{ db }, retry{ retry }, uncaught_exceptions{ std::uncaught_exceptions() }
+			{
+				ExecuteSql(db, BeginSql(mode), retry);
+			}
+
+			Transaction(Transaction&& other) noexcept
+				: db{ std::exchange(other.db, nullptr) }, retry{ other.retry }, uncaught_exceptions{ other.uncaught_exceptions }
+			{
+				// Nothing
+			}
+
+			Transaction& operator=(Transaction&&) = delete;
+
+			~Transaction()
+			{
+				if (!db)
+				{
+					return;
+				}
+
+				if (std::uncaught_exceptions() > uncaught_exceptions)
+				{
+					Rollback();
+
+					return;
+				}
+
+				try
+				{
+					Commit();
+				}
+				catch (std::exception const& e)
+				{
+					std::cerr << "sqlite transaction: commit on scope exit failed: " << e.what() << '\n';
+				}
+			}
+
+			// Note: A failed commit rolls the transaction back before rethrowing.
+			void Commit()
+			{
+				if (!db)
+				{
+					return;
+				}
+
+				try
+				{
+					ExecuteSql(db, "COMMIT;", retry);
+				}
+				catch (...)
+				{
+					Rollback();
+
+					throw;
+				}
+
+				db = nullptr;
+			}
+
+			// Returns false, after writing the error to std::cerr, if the transaction could not be rolled back.
+			bool Rollback() noexcept
+			{
+				return !db || RollbackSql(std::exchange(db, nullptr), "ROLLBACK;");
+			}
+
+			bool Active() const
+			{
+				return db != nullptr;
+			}
+
+		private:
+			sqlite3* db;
+			BusyRetry retry;
+			int uncaught_exceptions;
+
+			static char const* BeginSql(TransactionMode mode)
+			{
+				switch (mode)
+				{
+				case TransactionMode::Immediate:
+					return "BEGIN IMMEDIATE;";
+				case TransactionMode::Exclusive:
+					return "BEGIN EXCLUSIVE;";
+				default:
+					return "BEGIN DEFERRED;";
+				}
+			}
+		};
+
+		// Releases on scope exit, or rolls back to where it was taken when the scope is left by an exception.
+		// Note: Savepoints nest; the innermost one with a given name is the one released or rolled back,
+		// so every guard can share the same name. Outside a transaction the outermost savepoint starts one.
+		// As with Transaction, call Release() to have a failure to release thrown rather than written to std::cerr.
+		// A rollback also drops the changes it undid from change_feed, if given, so they are never dispatched.
+		class Savepoint final
+		{
+		public:
+			Savepoint(sqlite3* db, BusyRetry retry, ChangeFeed* change_feed = nullptr)
+				: db{ db }, retry{ retry }, uncaught_exceptions{ std::uncaught_exceptions() }, change_feed{ change_feed },
+				change_feed_mark{ change_feed ? change_feed->PendingMark() : ChangeFeed::Mark{} }
+			{
+				ExecuteSql(db, "SAVEPOINT tagged_sqlite;", retry);
+			}
+
+			Savepoint(Savepoint&& other) noexcept
+				: db{ std::exchange(other.db, nullptr) }, retry{ other.retry }, uncaught_exceptions{ other.uncaught_exceptions },
+				change_feed{ other.change_feed }, change_feed_mark{ std::move(other.change_feed_mark) }
+			{
+				// Nothing
+			}
+
+			Savepoint& operator=(Savepoint&&) = delete;
+
+			~Savepoint()
+			{
+				if (!db)
+				{
+					return;
+				}
+
+				if (std::uncaught_exceptions() > uncaught_exceptions)
+				{
+					Rollback();
+
+					return;
+				}
+
+				try
+				{
+					Release();
+				}
+				catch (std::exception const& e)
+				{
+					std::cerr << "sqlite savepoint: release on scope exit failed: " << e.what() << '\n';
+				}
+			}
+
+			void Release()
+			{
+				if (!db)
+				{
+					return;
+				}
+
+				try
+				{
+					ExecuteSql(db, "RELEASE tagged_sqlite;", retry);
+				}
+				catch (...)
+				{
+					Rollback();
+
+					throw;
+				}
+
+				db = nullptr;
+			}
+
+			// Returns false, after writing the error to std::cerr, if the savepoint could not be rolled back.
+			bool Rollback() noexcept
+			{
+				if (!db)
+				{
+					return true;
+				}
+
+				if (!RollbackSql(db, "ROLLBACK TO tagged_sqlite;"))
+				{
+					db = nullptr;
+
+					return false;
+				}
+
+				// Note: Before RELEASE, which commits when this savepoint began the transaction.
+				if (change_feed)
+				{
+					change_feed->RollbackTo(change_feed_mark);
+				}
+
+				return RollbackSql(std::exchange(db, nullptr), "RELEASE tagged_sqlite;");
+			}
+
+			bool Active() const
+			{
+				return db != nullptr;
+			}
+
+		private:
+			sqlite3* db;
+			BusyRetry retry;
+			int uncaught_exceptions;
+			ChangeFeed* change_feed;
+			ChangeFeed::Mark change_feed_mark;
+		};
+
+		// lifetime is SQLITE_STATIC only when p_tuple outlives every sqlite3_step of this binding,
+		// in which case strings and blobs are bound without being copied.
+		template <typename PTuple>
+		void DoBinding(sqlite3_stmt* stmt, PTuple const& p_tuple, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
+		{
+			auto index{ 1 };
+
+			p_tuple.ForEach([&](auto const& m) mutable {
+				auto r{ SqlType<std::remove_cvref_t<decltype(m.Value())>>::BindImpl(stmt, index, m.Value(), lifetime) };
+
+				CheckSqliteReturn<bool>(r, true);
+
+				++index;
+			});
+		}
+
+		// Size of a bound value: the characters or bytes of strings and blobs, the object size otherwise.
+		template <typename T>
+		std::size_t ValueBytes(T const& v)
+		{
+			if constexpr (requires { v.has_value(); })
+			{
+				return v ? ValueBytes(*v) : 0;
+			}
+			else if constexpr (std::is_same_v<T, std::filesystem::path>)
+			{
+				return std::size(v.native()) * sizeof(std::filesystem::path::value_type);
+			}
+			else if constexpr (requires { std::data(v); std::size(v); })
+			{
+				return std::size(v) * sizeof(*std::data(v));
+			}
+			else
+			{
+				return sizeof(T);
+			}
+		}
+
+		template <typename PTuple>
+		std::size_t BoundBytes(PTuple const& p_tuple)
+		{
+			std::size_t bytes{};
+
+			p_tuple.ForEach([&](auto const& m) {
+				bytes += ValueBytes(m.Value());
+			});
+
+			return bytes;
+		}
+
+		template <auto... Tags, typename... Ts, auto... Init, typename TT>
+		std::size_t BoundBytes(NDataStructure::TaggedTuple<NDataStructure::Member<Tags, Ts, Init>...> const*, NDataStructure::SoaVector<TT> const& rows, std::size_t row)
+		{
+			return (ValueBytes(NDataStructure::Get<Tags>(rows)[row]) + ... + std::size_t{});
+		}
+
+		// Binds the parameters of PTuple from the same-named columns of one SoaVector row.
+		// Note: Columns of the parameter's own type are bound in place, since rows outlives the step.
+		// Other columns go through a converted temporary and are copied.
+		template <auto... Tags, typename... Ts, auto... Init, typename TT>
+		void DoBinding(sqlite3_stmt* stmt, NDataStructure::TaggedTuple<NDataStructure::Member<Tags, Ts, Init>...> const*, NDataStructure::SoaVector<TT> const& rows, std::size_t row)
+		{
+			auto index{ 1 };
+
+			(CheckSqliteReturn<bool>(SqlType<Ts>::BindImpl(stmt, index++, NDataStructure::Get<Tags>(rows)[row],
+				std::same_as<std::remove_cvref_t<decltype(NDataStructure::Get<Tags>(rows)[row])>, Ts> ? SQLITE_STATIC : SQLITE_TRANSIENT), true), ...);
+		}
+
+		struct StmtCloser
+		{
+			void operator()(sqlite3_stmt* s)
+			{
+				if (s)
+				{
+					sqlite3_finalize(s);
+				}
+			}
+		};
+
+		using UniqueStmt = std::unique_ptr<sqlite3_stmt, StmtCloser>;
+
+		// Prepared statements kept for reuse, one per query, finalized in least recently used order
+		// once more than capacity are kept.
+		// Note: A statement is taken out of the cache while a PreparedStatement holds it,
+		// so two live PreparedStatements never share a handle.
+		// Identifies a query on a connection by the address of its text, plus a variant for queries built at run time
+		// from one template, such as the column set of a partial write as bits over the columns it may touch.
+		struct StatementKey
+		{
+			void const* query;
+			std::uint64_t variant{};
+
+			bool operator==(StatementKey const&) const = default;
+		};
+
+		struct StatementKeyHash
+		{
+			std::size_t operator()(StatementKey const& key) const noexcept
+			{
+				return std::hash<void const*>{}(key.query) ^ std::hash<std::uint64_t>{}(key.variant * 0x9e3779b97f4a7c15ull);
+			}
+		};
+
+		class StatementCache final
+		{
+			struct Entry
+			{
+				StatementKey key;
+				UniqueStmt stmt;
+			};
+
+		public:
+			explicit StatementCache(std::size_t capacity)
+				: capacity{ capacity }
+			{
+				// Nothing
+			}
+
+			StatementCache(StatementCache const&) = delete;
+			StatementCache& operator=(StatementCache const&) = delete;
+
+			UniqueStmt Acquire(StatementKey const& key)
+			{
+				auto it{ index.find(key) };
+
+				if (it == std::end(index))
+				{
+					return nullptr;
+				}
+
+				auto stmt{ std::move(it->second->stmt) };
+
+				entries.erase(it->second);
+				index.erase(it);
+
+				return stmt;
+			}
+
+			void Release(StatementKey const& key, UniqueStmt stmt)
+			{
+				// Note: Resetting ends any read transaction the statement kept open.
+				sqlite3_reset(stmt.get());
+				sqlite3_clear_bindings(stmt.get());
+
+				if (capacity == 0 || index.contains(key))
+				{
+					return;
+				}
+
+				entries.push_front({ key, std::move(stmt) });
+				index.emplace(key, std::begin(entries));
+
+				if (std::size(entries) > capacity)
+				{
+					index.erase(entries.back().key);
+					entries.pop_back();
+				}
+			}
+
+			void Capacity(std::size_t new_capacity)
+			{
+				capacity = new_capacity;
+
+				while (std::size(entries) > capacity)
+				{
+					index.erase(entries.back().key);
+					entries.pop_back();
+				}
+			}
+
+			std::size_t Capacity() const
+			{
+				return capacity;
+			}
+
+			std::size_t size() const
+			{
+				return std::size(entries);
+			}
+
+			void clear()
+			{
+				index.clear();
+				entries.clear();
+			}
+
+		private:
+			std::size_t capacity;
+			std::list<Entry> entries;	// Most recently used first
+			std::unordered_map<StatementKey, typename std::list<Entry>::iterator, StatementKeyHash> index;
+		};
+
+		// StatementStatistics of every query profiled on a connection, keyed like StatementCache.
+		// Note: Profiling is off until Enable(true). The statistics are not synchronized, so read them
+		// on the thread that uses the connection. Counters of a statement still in use are added when it is reset or released.
+		class StatementProfiler final
+		{
+		public:
+			StatementProfiler() = default;
+			StatementProfiler(StatementProfiler const&) = delete;
+			StatementProfiler& operator=(StatementProfiler const&) = delete;
+
+			void Enable(bool on)
+			{
+				enabled = on;
+			}
+
+			bool Enabled() const
+			{
+				return enabled;
+			}
+
+			// Returns the statistics of the query identified by key, or nullptr while profiling is off.
+			StatementStatistics* Find(StatementKey const& key, std::string_view query)
+			{
+				if (!enabled)
+				{
+					return nullptr;
+				}
+
+				auto [it, inserted]{ statistics.try_emplace(key) };
+
+				if (inserted)
+				{
+					it->second.query = query;
+				}
+
+				return &it->second;
+			}
+
+			// Most expensive query first.
+			std::vector<StatementStatistics const*> Snapshot() const
+			{
+				std::vector<StatementStatistics const*> result;
+
+				for (auto const& [key, s] : statistics)
+				{
+					result.push_back(&s);
+				}
+
+				std::ranges::sort(result, std::greater{}, [](StatementStatistics const* s) {
+					return std::max(s->execute_latency.total, s->step_latency.total);
+				});
+
+				return result;
+			}
+
+			void Report(std::ostream& os) const
+			{
+				auto us{ [](std::chrono::nanoseconds d) {
+					return std::chrono::duration<double, std::micro>{ d }.count();
+				} };
+				auto latency{ [&](char const* name, LatencyHistogram const& h) {
+					os << "  " << name << ": count " << h.count << ", mean " << us(h.Mean()) << "us, p50 " << us(h.Percentile(0.5))
+						<< "us, p99 " << us(h.Percentile(0.99)) << "us, max " << us(h.max) << "us\n";
+				} };
+
+				for (auto s : Snapshot())
+				{
+					os << s->query << '\n'
+						<< "  executions " << s->executions << ", prepares " << s->prepares << " (" << us(s->prepare_time) << "us), cache hits " << s->cache_hits << '\n';
+					latency("execute", s->execute_latency);
+					latency("step", s->step_latency);
+					os << "  rows " << s->rows << ", bytes bound " << s->bytes_bound << ", bytes read " << s->bytes_read << '\n'
+						<< "  full scan steps " << s->full_scan_steps << ", sorts " << s->sorts << ", autoindex " << s->autoindex << ", vm steps " << s->vm_steps << '\n';
+				}
+			}
+
+			// Zeroes every counter. Statistics stay at the same address, since live statements point to them.
+			void Reset()
+			{
+				for (auto& [key, s] : statistics)
+				{
+					s = StatementStatistics{ .query = s.query };
+				}
+			}
+
+		private:
+			bool enabled{ false };
+			std::unordered_map<StatementKey, StatementStatistics, StatementKeyHash> statistics;
+		};
+
+		enum class QueryPlanPolicy
+		{
+			Ignore,
+			Report,	// Writes each finding to std::clog and keeps it in Issues()
+			Throw,	// Also throws from the PreparedStatement constructor
+		};
+
+		struct QueryPlanRules
+		{
+			bool full_scan{ true };		// SCAN of a table without an index
+			bool temp_b_tree{ true };	// USE TEMP B-TREE for ORDER BY, GROUP BY or DISTINCT
+		};
+
+		struct QueryPlanIssue
+		{
+			std::string query;
+			std::string detail;
+		};
+
+		// Runs EXPLAIN QUERY PLAN when a query is first prepared on a connection and flags the steps QueryPlanRules asks for.
+		// Meant for debug builds and tests, so missing indexes show up before production.
+		// Note: A query that fails under QueryPlanPolicy::Throw is checked again on every prepare, so it keeps failing.
+		class QueryPlanVerifier final
+		{
+		public:
+			QueryPlanVerifier() = default;
+			QueryPlanVerifier(QueryPlanVerifier const&) = delete;
+			QueryPlanVerifier& operator=(QueryPlanVerifier const&) = delete;
+
+			void Policy(QueryPlanPolicy new_policy, QueryPlanRules new_rules = {})
+			{
+				policy = new_policy;
+				rules = new_rules;
+			}
+
+			QueryPlanPolicy Policy() const
+			{
+				return policy;
+			}
+
+			std::vector<QueryPlanIssue> const& Issues() const
+			{
+				return issues;
+			}
+
+			void clear()
+			{
+				verified.clear();
+				issues.clear();
+			}
+
+			void Verify(sqlite3* db, StatementKey const& key, std::string_view query)
+			{
+				if (policy == QueryPlanPolicy::Ignore || verified.contains(key))
+				{
+					return;
+				}
+
+				auto const first_issue{ std::size(issues) };
+				std::string explain{ "EXPLAIN QUERY PLAN " };
+				sqlite3_stmt* stmt;
+
+				explain += query;
+				CheckSqliteReturn(sqlite3_prepare_v2(db, std::data(explain), static_cast<int>(std::size(explain)), &stmt, nullptr));
+
+				UniqueStmt plan{ stmt };
+				int r;
+
+				// Columns: id, parent, notused, detail
+				while ((r = sqlite3_step(stmt)) == SQLITE_ROW)
+				{
+					auto text{ reinterpret_cast<char const*>(sqlite3_column_text(stmt, 3)) };
+					std::string_view detail{ text ? text : "" };
+
+					if (rules.full_scan && detail.starts_with("SCAN ") && detail.find(" USING ") == std::string_view::npos && detail != "SCAN CONSTANT ROW"
+						&& !IsSchemaScan(detail))
+					{
+						issues.push_back({ std::string{ query }, std::string{ detail } });
+					}
+					else if (rules.temp_b_tree && detail.find("USE TEMP B-TREE") != std::string_view::npos)
+					{
+						issues.push_back({ std::string{ query }, std::string{ detail } });
+					}
+				}
+
+				CheckSqliteReturn(r, SQLITE_DONE);
+
+				if (std::size(issues) == first_issue)
+				{
+					verified.insert(key);
+
+					return;
+				}
+
+				for (auto i{ first_issue }; i != std::size(issues); ++i)
+				{
+					std::clog << "query plan: " << issues[i].detail << " in " << query << '\n';
+				}
+
+				if (policy == QueryPlanPolicy::Throw)
+				{
+					throw std::runtime_error{ "sqlite query plan: " + issues[first_issue].detail + " in " + std::string{ query } };
+				}
+
+				verified.insert(key);
+			}
+
+		private:
+			// Note: The schema table has no index, so schema queries (ExistTable, ...) always scan it.
+			static bool IsSchemaScan(std::string_view detail)
+			{
+				detail.remove_prefix(std::size("SCAN ") - 1);
+
+				// Note: SQLite before 3.36 writes "SCAN TABLE name"
+				if (detail.starts_with("TABLE "))
+				{
+					detail.remove_prefix(std::size("TABLE ") - 1);
+				}
+
+				auto const table{ detail.substr(0, detail.find(' ')) };
+
+				return table == "sqlite_master" || table == "sqlite_schema" || table == "sqlite_temp_master" || table == "sqlite_temp_schema";
+			}
+
+			QueryPlanPolicy policy{ QueryPlanPolicy::Ignore };
+			QueryPlanRules rules;
+			std::unordered_set<StatementKey, StatementKeyHash> verified;
+			std::vector<QueryPlanIssue> issues;
+		};
+
+		template <FixedString query_string>
+		class PreparedStatement
+		{
+			using RowType = decltype(MakeMembers<query_string>());
+			using PTuple = decltype(MakeParameters<query_string>());
+
+		public:
+			using ParameterTuple = PTuple;
+			using ConcreteRowType = decltype(ToConcrete(std::declval<RowType>()));
+
+			PreparedStatement(sqlite3* sqldb)
+				: stmt{ Prepare(sqldb) }
+			{
+				// Nothing
+			}
+
+			// Reuses the statement cached for query_string, if any, and gives it back on destruction.
+			// Records into profiler, when given and enabled, and has verifier check the plan of a newly prepared statement.
+			PreparedStatement(sqlite3* sqldb, StatementCache& cache, StatementProfiler* profiler = nullptr, QueryPlanVerifier* verifier = nullptr)
+				: stmt{ cache.Acquire({ &cache_key }) }, cache{ &cache }, statistics{ profiler ? profiler->Find({ &cache_key }, query_string.ToStringView()) : nullptr }
+			{
+				if (!stmt)
+				{
+					auto const begin{ std::chrono::steady_clock::now() };
+
+					stmt = Prepare(sqldb);
+
+					if (statistics)
+					{
+						++statistics->prepares;
+						statistics->prepare_time += std::chrono::steady_clock::now() - begin;
+					}
+
+					if (verifier)
+					{
+						verifier->Verify(sqldb, { &cache_key }, query_string.ToStringView());
+					}
+				}
+				else if (statistics)
+				{
+					++statistics->cache_hits;
+				}
+			}
+
+			PreparedStatement(PreparedStatement&& other) noexcept
+				: stmt{ std::move(other.stmt) }, cache{ other.cache }, statistics{ other.statistics }
+			{
+				// Nothing
+			}
+
+			PreparedStatement& operator=(PreparedStatement&& other) noexcept
+			{
+				if (this != &other)
+				{
+					Release();
+					stmt = std::move(other.stmt);
+					cache = other.cache;
+					statistics = other.statistics;
+				}
+
+				return *this;
+			}
+
+			~PreparedStatement()
+			{
+				Release();
+			}
+
+			// Note: The returned range steps this statement, so the statement must outlive it and must not be executed again
+			// while it is in use. The range-returning Execute functions are lvalue-only for that reason.
+			RowRange<RowType> ExecuteRows() & requires(std::empty(PTuple))
+			{
+				ResetStmt();
+
+				return RowRange<RowType>(stmt.get(), statistics);
+			}
+
+			// Note: Parameters are copied by SQLite, since the rows are stepped after p_tuple is gone.
+			RowRange<RowType> ExecuteRows(PTuple const& p_tuple) &
+			{
+				ResetStmt();
+				BindParameters(p_tuple);
+
+				return RowRange<RowType>(stmt.get(), statistics);
+			}
+
+			// Appends every result row to rows, decoding each column into its column vector. Returns the number of rows appended.
+			// Note: View columns (text&, blob&) are stored as their owning types, since the rows outlive the statement step.
+			std::size_t ExecuteInto(NDataStructure::SoaVector<ConcreteRowType>& rows) requires(PTuple::empty())
+			{
+				ExecutionTimer timer{ statistics };
+
+				ResetStmt();
+
+				return StepInto(rows);
+			}
+
+			std::size_t ExecuteInto(NDataStructure::SoaVector<ConcreteRowType>& rows, PTuple const& p_tuple)
+			{
+				ExecutionTimer timer{ statistics };
+
+				ResetStmt();
+				BindParameters(p_tuple, SQLITE_STATIC);
+
+				return StepInto(rows);
+			}
+
+			// Iterates the result in SoaVector batches of up to batch_size rows.
+			BatchRange<NDataStructure::SoaVector<ConcreteRowType>> ExecuteBatches(std::size_t batch_size) & requires(PTuple::empty())
+			{
+				ResetStmt();
+
+				return { stmt.get(), batch_size, statistics };
+			}
+
+			BatchRange<NDataStructure::SoaVector<ConcreteRowType>> ExecuteBatches(std::size_t batch_size, PTuple const& p_tuple) &
+			{
+				ResetStmt();
+				BindParameters(p_tuple);
+
+				return { stmt.get(), batch_size, statistics };
+			}
+
+			// Decodes the result on a producer thread into batch_count batches of up to batch_size rows, overlapping
+			// the SQLite step loop with the consumer's work.
+			// Note: The producer thread steps this statement until the range is destroyed, so the range must be destroyed
+			// before the statement is moved from, destroyed or executed again.
+			PipelinedRows<NDataStructure::SoaVector<ConcreteRowType>> ExecutePipelined(std::size_t batch_size, std::size_t batch_count) & requires(PTuple::empty())
+			{
+				ResetStmt();
+
+				return { stmt.get(), batch_size, batch_count, statistics };
+			}
+
+			PipelinedRows<NDataStructure::SoaVector<ConcreteRowType>> ExecutePipelined(std::size_t batch_size, std::size_t batch_count, PTuple const& p_tuple) &
+			{
+				ResetStmt();
+				BindParameters(p_tuple);
+
+				return { stmt.get(), batch_size, batch_count, statistics };
+			}
+
+			std::optional<decltype(ToConcrete(std::declval<RowType>()))> ExecuteSingleRow(PTuple const& p_tuple)
+			{
+				ExecutionTimer timer{ statistics };
+
+				ResetStmt();
+				BindParameters(p_tuple, SQLITE_STATIC);
+
+				RowRange<RowType> rng(stmt.get(), statistics);
+				
+				if (auto begin{ std::begin(rng) }; begin != std::end(rng))
+				{
+					return ToConcrete(*begin);
+				}
+				else
+				{
+					return std::nullopt;
+				}
+			}
+
+			std::optional<decltype(ToConcrete(std::declval<RowType>()))> ExecuteSingleRow()
+				requires (PTuple::empty())
+			{
+				ExecutionTimer timer{ statistics };
+				auto rng{ ExecuteRows() };
+				
+				if (auto begin{ std::begin(rng) }; begin != std::end(rng))
+				{
+					return ToConcrete(*begin);
+				}
+				else
+				{
+					return std::nullopt;
+				}
+			}
+
+			// Binds strings and blobs in place: p_tuple outlives the step, and the next execution resets the bindings.
+			// Note: Build a ParameterTuple by moving large values into it and pass it here to avoid every copy.
+			void Execute(PTuple const& p_tuple)
+			{
+				ExecutionTimer timer{ statistics };
+
+				ResetStmt();
+				BindParameters(p_tuple, SQLITE_STATIC);
+				
+				auto r{ Step(stmt.get(), statistics) };
+
+				CheckSqliteReturn(r, SQLITE_DONE);
+			}
+
+			void Execute()
+				requires (PTuple::empty())
+			{
+				ExecutionTimer timer{ statistics };
+
+				ResetStmt();
+				
+				auto r{ Step(stmt.get(), statistics) };
+
+				CheckSqliteReturn(r, SQLITE_DONE);
+			}
+
+			// Executes the statement once per row, committing every chunk_size rows (0: all rows) as one transaction.
+			// Note: When a transaction is already open the rows join it and nothing is committed here.
+			// Returns the number of rows changed.
+			template <std::ranges::input_range Rows>
+				requires std::convertible_to<std::ranges::range_reference_t<Rows>, PTuple>
+			std::size_t ExecuteBatch(Rows&& rows, std::size_t chunk_size = default_batch_chunk_size)
+			{
+				auto it{ std::ranges::begin(rows) };
+				auto const last{ std::ranges::end(rows) };
+
+				return ExecuteBatchImpl(chunk_size, [&] {
+					if (it == last)
+					{
+						return false;
+					}
+
+					// Note: Rows that are not PTuple lvalues are converted to a temporary, which is gone before the step.
+					// An input-only range may also reuse one cached element, which ++it overwrites before the step.
+					if constexpr (std::ranges::forward_range<Rows>
+						&& std::is_lvalue_reference_v<std::ranges::range_reference_t<Rows>>
+						&& std::same_as<std::remove_cvref_t<std::ranges::range_reference_t<Rows>>, PTuple>)
+					{
+						BindParameters(*it, SQLITE_STATIC);
+					}
+					else
+					{
+						BindParameters(PTuple(*it));
+					}
+
+					++it;
+
+					return true;
+				});
+			}
+
+			// Binds each parameter from the SoaVector column of the same name.
+			template <typename TT>
+			std::size_t ExecuteBatch(NDataStructure::SoaVector<TT> const& rows, std::size_t chunk_size = default_batch_chunk_size)
+			{
+				std::size_t row{};
+
+				return ExecuteBatchImpl(chunk_size, [&] {
+					if (row == std::size(rows))
+					{
+						return false;
+					}
+
+					DoBinding(stmt.get(), static_cast<PTuple const*>(nullptr), rows, row);
+
+					if (statistics)
+					{
+						statistics->bytes_bound += BoundBytes(static_cast<PTuple const*>(nullptr), rows, row);
+					}
+
+					++row;
+
+					return true;
+				});
+			}
+
+		private:
+			UniqueStmt stmt;
+			StatementCache* cache{ nullptr };
+			StatementStatistics* statistics{ nullptr };
+
+			static inline constexpr char cache_key{};	// Address identifies query_string in StatementCache and StatementProfiler
+
+			static UniqueStmt Prepare(sqlite3* sqldb)
+			{
+				auto sv{ query_string.ToStringView() };
+				sqlite3_stmt* stmt;
+				auto rc{ sqlite3_prepare_v2(sqldb, std::data(sv), static_cast<int>(std::size(sv)), &stmt, 0) };
+
+				CheckSqliteReturn(rc);
+
+				UniqueStmt result{ stmt };
+
+				if constexpr (!RowType::empty())
+				{
+					CheckColumnCount<RowType>(stmt);
+				}
+
+				return result;
+			}
+
+			void Release()
+			{
+				if (statistics && stmt)
+				{
+					statistics->Collect(stmt.get());
+				}
+
+				if (cache && stmt)
+				{
+					cache->Release({ &cache_key }, std::move(stmt));
+				}
+			}
+
+			void ResetStmt()
+			{
+				if (statistics)
+				{
+					statistics->Collect(stmt.get());
+				}
+
+				auto r{ sqlite3_reset(stmt.get()) };
+
+				CheckSqliteReturn(r);
+				r = sqlite3_clear_bindings(stmt.get());
+				CheckSqliteReturn(r);
+			}
+
+			void BindParameters(PTuple const& p_tuple, sqlite3_destructor_type lifetime = SQLITE_TRANSIENT)
+			{
+				DoBinding(stmt.get(), p_tuple, lifetime);
+
+				if (statistics)
+				{
+					statistics->bytes_bound += BoundBytes(p_tuple);
+				}
+			}
+
+			std::size_t StepInto(NDataStructure::SoaVector<ConcreteRowType>& rows)
+			{
+				auto const size{ std::size(rows) };
+
+				while (true)
+				{
+					auto r{ Step(stmt.get(), statistics) };
+
+					CheckSqliteReturn(r, SQLITE_DONE, SQLITE_ROW);
+
+					if (r == SQLITE_DONE)
+					{
+						return std::size(rows) - size;
+					}
+
+					AppendRowInto(stmt.get(), rows);
+				}
+			}
+
+			// bind_next() binds the next row and returns false when there is none left.
+			template <typename BindNext>
+			std::size_t ExecuteBatchImpl(std::size_t chunk_size, BindNext bind_next)
+			{
+				ExecutionTimer timer{ statistics };
+				auto db{ sqlite3_db_handle(stmt.get()) };
+				auto const own_transaction{ sqlite3_get_autocommit(db) != 0 };
+				auto in_transaction{ false };
+				std::size_t in_chunk{};
+				std::size_t changes{};
+
+				try
+				{
+					while (true)
+					{
+						ResetStmt();
+
+						if (!bind_next())
+						{
+							break;
+						}
+
+						if (own_transaction && !in_transaction)
+						{
+							ExecuteSql(db, "BEGIN;");
+							in_transaction = true;
+						}
+
+						auto r{ Step(stmt.get(), statistics) };
+
+						CheckSqliteReturn(r, SQLITE_DONE);
+						changes += static_cast<std::size_t>(sqlite3_changes(db));
+
+						if (in_transaction && ++in_chunk == chunk_size)
+						{
+							ExecuteSql(db, "COMMIT;");
+							in_transaction = false;
+							in_chunk = 0;
+						}
+					}
+
+					if (in_transaction)
+					{
+						ExecuteSql(db, "COMMIT;");
+					}
+				}
+				catch (...)
+				{
+					sqlite3_reset(stmt.get());
+
+					if (in_transaction)
+					{
+						sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+					}
+
+					throw;
+				}
+
+				return changes;
+			}
+		};
+
+		// NAT = NameAndType
+		template <auto NAT, TemplateTemplateParameter<NDataStructure::InternalTaggedTuple::TaggedTuple> T>
+			requires requires { NAT.Name(); }
+		decltype(auto) Field(T&& t)
+		{
+			return NDataStructure::Get<NAT.Name()>(std::forward<T>(t));
+		}
+
+		template <FixedString fs, TemplateTemplateParameter<NDataStructure::InternalTaggedTuple::TaggedTuple> T>
+		decltype(auto) Field(T&& t)
+		{
+			return NDataStructure::Get<fs>(std::forward<T>(t));
+		}
+
+		// NAT = NameAndType
+		template <auto NAT, std::convertible_to<typename decltype(NAT)::value_type> T>
+			requires requires { NAT.Name(); }
+		auto Bind(T&& t)
+		{
+			return NDataStructure::tag<NAT.Name()> = std::forward<T>(t);
+		}
+
+		template <FixedString fs, typename T>
+		auto Bind(T&& t)
+		{
+			return NDataStructure::tag<fs> = std::forward<T>(t);
+		}
+
+		enum class JournalMode
+		{
+			Delete,
+			Truncate,
+			Persist,
+			Memory,
+			Wal,
+			Off,
+		};
+
+		enum class Synchronous
+		{
+			Off,
+			Normal,
+			Full,
+			Extra,
+		};
+
+		enum class TempStore
+		{
+			Default,
+			File,
+			Memory,
+		};
+
+		// Connection tuning. Members left empty are not touched.
+		struct PragmaSettings
+		{
+			std::optional<JournalMode> journal_mode;
+			std::optional<Synchronous> synchronous;
+			std::optional<std::int64_t> cache_size;	// Pages, or KiB when negative
+			std::optional<std::int64_t> mmap_size;	// Bytes
+			std::optional<TempStore> temp_store;	// Note: A change drops every TEMP table of the connection
+			std::optional<std::int64_t> page_size;	// Note: Only takes effect on an empty database or at the next VACUUM outside WAL mode
+			std::optional<std::chrono::milliseconds> busy_timeout;
+		};
+
+		namespace PragmaProfiles
+		{
+			// Loads that are simply rerun if the process dies midway: no fsync, a 256 MiB cache and 1 GiB of mmap.
+			// Note: A power loss during the load can corrupt the database, so apply it through PragmaScope around the load only.
+			// temp_store is left alone, since changing it on apply and again on revert would drop the load's TEMP tables.
+			inline constexpr PragmaSettings bulk_load{
+				.synchronous = Synchronous::Off,
+				.cache_size = -256 * 1024,
+				.mmap_size = std::int64_t{ 1 } << 30,
+			};
+
+			// Many readers beside one writer: WAL, fsync only at checkpoints, reads served from mmap.
+			inline constexpr PragmaSettings read_mostly{
+				.journal_mode = JournalMode::Wal,
+				.synchronous = Synchronous::Normal,
+				.cache_size = -64 * 1024,
+				.mmap_size = std::int64_t{ 256 } << 20,
+				.temp_store = TempStore::Memory,
+				.busy_timeout = std::chrono::milliseconds{ 5000 },
+			};
+		}
+
+		// Looks a profile up by the name used in configuration files: "bulk-load" or "read-mostly".
+		inline std::optional<PragmaSettings> FindPragmaProfile(std::string_view name)
+		{
+			if (name == "bulk-load")
+			{
+				return PragmaProfiles::bulk_load;
+			}
+			else if (name == "read-mostly")
+			{
+				return PragmaProfiles::read_mostly;
+			}
+
+			return std::nullopt;
+		}
+
+		inline constexpr std::string_view journal_mode_names[]{ "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF" };
+
+		inline UniqueStmt QueryPragma(sqlite3* db, char const* sql)
+		{
+			sqlite3_stmt* stmt;
+
+			CheckSqliteReturn(sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr));
+
+			UniqueStmt result{ stmt };
+
+			CheckSqliteReturn(sqlite3_step(stmt), SQLITE_ROW);
+
+			return result;
+		}
+
+		inline std::int64_t QueryPragmaInteger(sqlite3* db, char const* sql)
+		{
+			return sqlite3_column_int64(QueryPragma(db, sql).get(), 0);
+		}
+
+		// Empty when the pragma returns no row, as mmap_size does on a database that cannot be memory-mapped (":memory:").
+		inline std::optional<std::int64_t> QueryOptionalPragmaInteger(sqlite3* db, char const* sql)
+		{
+			sqlite3_stmt* stmt;
+
+			CheckSqliteReturn(sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr));
+
+			UniqueStmt result{ stmt };
+			auto const r{ sqlite3_step(stmt) };
+
+			CheckSqliteReturn(r, SQLITE_ROW, SQLITE_DONE);
+
+			return r == SQLITE_ROW ? std::optional{ sqlite3_column_int64(stmt, 0) } : std::nullopt;
+		}
+
+		// Reads every setting of PragmaSettings from the connection. mmap_size stays empty where SQLite reports none.
+		inline PragmaSettings ReadPragmas(sqlite3* db)
+		{
+			PragmaSettings settings;
+			auto const journal_mode{ QueryPragma(db, "PRAGMA journal_mode;") };
+			std::string_view name{ reinterpret_cast<char const*>(sqlite3_column_text(journal_mode.get(), 0)) };
+
+			for (std::size_t i{}; i != std::size(journal_mode_names); ++i)
+			{
+				if (std::ranges::equal(name, journal_mode_names[i], [](char a, char b) {
+					return std::toupper(static_cast<unsigned char>(a)) == b;
+				}))
+				{
+					settings.journal_mode = static_cast<JournalMode>(i);
+				}
+			}
+
+			settings.synchronous = static_cast<Synchronous>(QueryPragmaInteger(db, "PRAGMA synchronous;"));
+			settings.cache_size = QueryPragmaInteger(db, "PRAGMA cache_size;");
+			settings.mmap_size = QueryOptionalPragmaInteger(db, "PRAGMA mmap_size;");
+			settings.temp_store = static_cast<TempStore>(QueryPragmaInteger(db, "PRAGMA temp_store;"));
+			settings.page_size = QueryPragmaInteger(db, "PRAGMA page_size;");
+			settings.busy_timeout = std::chrono::milliseconds{ QueryPragmaInteger(db, "PRAGMA busy_timeout;") };
+
+			return settings;
+		}
+
+		// Runs each pragma on its own, so one that fails (journal_mode or temp_store inside a transaction, ...) does not
+		// keep the others from being applied. Returns "name: error" of every pragma that failed, or an empty string.
+		// Note: PRAGMA values cannot be bound as parameters, so the statement is built as text from the typed values.
+		inline std::string WritePragmas(sqlite3* db, PragmaSettings const& settings, BusyRetry const& retry)
+		{
+			std::string failed;
+			auto const append{ [&](std::string_view pragma, auto const& value) {
+				std::string sql{ "PRAGMA " };
+
+				sql.append(pragma).append(" = ").append(value).append(";");
+
+				if (TryExecuteSql(db, sql.c_str(), retry) != SQLITE_OK)
+				{
+					failed.append(std::empty(failed) ? "" : ", ").append(pragma).append(": ").append(sqlite3_errmsg(db));
+				}
+			} };
+
+			// Note: page_size goes first, since it can no longer change once journal_mode is WAL.
+			if (settings.page_size)
+			{
+				append("page_size", std::to_string(*settings.page_size));
+			}
+
+			if (settings.journal_mode)
+			{
+				append("journal_mode", journal_mode_names[static_cast<std::size_t>(*settings.journal_mode)]);
+			}
+
+			if (settings.synchronous)
+			{
+				append("synchronous", std::to_string(static_cast<int>(*settings.synchronous)));
+			}
+
+			if (settings.cache_size)
+			{
+				append("cache_size", std::to_string(*settings.cache_size));
+			}
+
+			if (settings.mmap_size)
+			{
+				append("mmap_size", std::to_string(*settings.mmap_size));
+			}
+
+			if (settings.temp_store)
+			{
+				append("temp_store", std::to_string(static_cast<int>(*settings.temp_store)));
+			}
+
+			if (settings.busy_timeout)
+			{
+				append("busy_timeout", std::to_string(settings.busy_timeout->count()));
+			}
+
+			return failed;
+		}
+
+		// Applies settings for the lifetime of the scope, then restores the values they replaced.
+		//	{
+		//		auto scope{ sql.ApplyPragmas(PragmaProfiles::bulk_load) };
+		//		...
+		//	}
+		// Note: When a pragma cannot be applied, the ones that were are restored and the constructor throws.
+		// A failure to restore on scope exit is written to std::cerr; call Restore() to have it thrown.
+		class PragmaScope final
+		{
+		public:
+			PragmaScope(sqlite3* db, PragmaSettings const& settings, BusyRetry retry)
+				: db{ db }, retry{ retry }, previous{ Replaced(ReadPragmas(db), settings) }
+			{
+				if (auto const failed{ WritePragmas(db, settings, retry) }; !std::empty(failed))
+				{
+					// Note: Pragmas that failed to apply fail again here, which leaves them as they were.
+					WritePragmas(db, previous, retry);
+
+					throw std::runtime_error{ "sqlite pragma: " + failed };
+				}
+			}
+
+			PragmaScope(PragmaScope&& other) noexcept
+				: db{ std::exchange(other.db, nullptr) }, retry{ other.retry }, previous{ other.previous }
+			{
+				// Nothing
+			}
+
+			PragmaScope& operator=(PragmaScope&&) = delete;
+
+			~PragmaScope()
+			{
+				try
+				{
+					Restore();
+				}
+				catch (std::exception const& e)
+				{
+					std::cerr << "sqlite pragma scope: restore on scope exit failed: " << e.what() << '\n';
+				}
+			}
+
+			// Restores every replaced value it can, then throws naming the ones it could not.
+			void Restore()
+			{
+				if (!db)
+				{
+					return;
+				}
+
+				if (auto const failed{ WritePragmas(std::exchange(db, nullptr), previous, retry) }; !std::empty(failed))
+				{
+					throw std::runtime_error{ "sqlite pragma: " + failed };
+				}
+			}
+
+			PragmaSettings const& Previous() const
+			{
+				return previous;
+			}
+
+		private:
+			sqlite3* db;
+			BusyRetry retry;
+			PragmaSettings previous;
+
+			// Keeps only the members of current that settings changes.
+			static PragmaSettings Replaced(PragmaSettings const& current, PragmaSettings const& settings)
+			{
+				auto const keep{ [](auto const& value, auto const& changed) {
+					return changed ? value : std::nullopt;
+				} };
+
+				return {
+					.journal_mode = keep(current.journal_mode, settings.journal_mode),
+					.synchronous = keep(current.synchronous, settings.synchronous),
+					.cache_size = keep(current.cache_size, settings.cache_size),
+					.mmap_size = keep(current.mmap_size, settings.mmap_size),
+					.temp_store = keep(current.temp_store, settings.temp_store),
+					.page_size = keep(current.page_size, settings.page_size),
+					.busy_timeout = keep(current.busy_timeout, settings.busy_timeout),
+				};
+			}
+		};
+
+		enum class BlobAccess
+		{
+			ReadOnly,
+			ReadWrite,
+		};
+
+		// Incremental I/O on one BLOB value, so a large payload never has to be held in memory as a whole.
+		//	sql.PrepareStatement<"INSERT INTO accounts(row, profile_picture) VALUES(?/*:row:integer*/, ?/*:picture_size:zeroblob*/);">()
+		//		.Execute({ Bind<row>(1), Bind<"picture_size"_fs>(ZeroBlob{ size }) });
+		//
+		//	auto blob{ sql.OpenBlob<accounts, profile_picture>(1, BlobAccess::ReadWrite) };
+		//
+		//	blob.Write(0, first_chunk);
+		// Note: A BLOB cannot grow or shrink through its stream, so reserve the size with ZeroBlob first.
+		// Once its row is changed by anything else the stream expires, and every Read or Write throws.
+		// Every stream must be gone before its connection is closed.
+		class BlobStream final
+		{
+			struct BlobCloser
+			{
+				void operator()(sqlite3_blob* b)
+				{
+					sqlite3_blob_close(b);
+				}
+			};
+
+		public:
+			BlobStream(sqlite3* db, char const* table, char const* column, std::int64_t rowid, BlobAccess access)
+			{
+				sqlite3_blob* b{ nullptr };
+				auto r{ sqlite3_blob_open(db, "main", table, column, rowid, access == BlobAccess::ReadWrite, &b) };
+
+				blob.reset(b);
+				CheckSqliteReturn(r);
+			}
+
+			std::size_t size() const
+			{
+				return static_cast<std::size_t>(sqlite3_blob_bytes(blob.get()));
+			}
+
+			// Fills buffer with the bytes from offset on. Throws std::out_of_range unless the range lies within the BLOB.
+			void Read(std::size_t offset, std::span<unsigned char> buffer) const
+			{
+				CheckRange(offset, std::size(buffer));
+				CheckSqliteReturn(sqlite3_blob_read(blob.get(), std::data(buffer), static_cast<int>(std::size(buffer)), static_cast<int>(offset)));
+			}
+
+			void Write(std::size_t offset, std::span<unsigned char const> bytes)
+			{
+				CheckRange(offset, std::size(bytes));
+				CheckSqliteReturn(sqlite3_blob_write(blob.get(), std::data(bytes), static_cast<int>(std::size(bytes)), static_cast<int>(offset)));
+			}
+
+			// Moves to the same column of another row, which is much cheaper than opening a new stream.
+			void Reopen(std::int64_t rowid)
+			{
+				CheckSqliteReturn(sqlite3_blob_reopen(blob.get(), rowid));
+			}
 
-			p_tuple.ForEach([&](auto& m) mutable {
-				using m_t = std::decay_t<decltype(m)>;
-				using Tag = typename m_t::TagType;
+			// Reads the BLOB front to back through buffer and calls f(chunk, offset) for each filled part.
+			// Throws std::invalid_argument on an empty buffer, which could never make progress.
+			template <typename F>
+			void ForEachChunk(std::span<unsigned char> buffer, F&& f) const
+			{
+				if (std::empty(buffer))
+				{
+					throw std::invalid_argument{ "sqlite blob: ForEachChunk needs a non-empty buffer" };
+				}
 
-				auto r{ SqlType<std::remove_cvref_t<decltype(m.Value())>>::BindImpl(stmt, index, m.Value()) };
+				auto const total{ size() };
 
-				CheckSqliteReturn<bool>(r, true);
+				for (std::size_t offset{}; offset < total; offset += std::size(buffer))
+				{
+					auto const chunk{ buffer.first(std::min(std::size(buffer), total - offset)) };
 
-				++index;
-			});
-		}
+					Read(offset, chunk);
+					f(std::span<unsigned char const>{ chunk }, offset);
+				}
+			}
 
-		struct StmtCloser
-		{
-			void operator()(sqlite3_stmt* s)
+		private:
+			// Note: size() fits in an int, so a range within it can be passed to sqlite3_blob_read/write as is.
+			void CheckRange(std::size_t offset, std::size_t length) const
 			{
-				if (s)
+				auto const total{ size() };
+
+				if (offset > total || length > total - offset)
 				{
-					sqlite3_finalize(s);
+					throw std::out_of_range{ "sqlite blob: " + std::to_string(length) + " bytes at " + std::to_string(offset)
+						+ " are past the end of " + std::to_string(total) + " bytes" };
 				}
 			}
+
+			std::unique_ptr<sqlite3_blob, BlobCloser> blob;
 		};
 
-		using UniqueStmt = std::unique_ptr<sqlite3_stmt, StmtCloser>;
+		using Literals::operator""_fs;
 
-		template <FixedString query_string>
-		class PreparedStatement
+		class SQLite3Manager final
 		{
-			using RowType = decltype(MakeMembers<query_string>());
-			using PTuple = decltype(MakeParameters<query_string>());
-
 		public:
-			PreparedStatement(sqlite3* sqldb)
+			// Note: Pass SQLITE_OPEN_NOMUTEX in open_flags only when the connection is never used by two threads at once.
+			explicit SQLite3Manager(std::filesystem::path const& path_name, std::size_t statement_cache_capacity = 64, int open_flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)
+				: statement_cache{ statement_cache_capacity }
 			{
-				auto sv{ query_string.ToStringView() };
-				sqlite3_stmt* stmt;
-				//auto specs{ ParseTypeSpecs<query_string>() };
-				auto rc{ sqlite3_prepare_v2(sqldb, std::data(sv), static_cast<int>(std::size(sv)), &stmt, 0) };
+				auto const r{ sqlite3_open_v2(path_name.string().c_str(), &db, open_flags, nullptr) };
 
-				CheckSqliteReturn(rc);
-				this->stmt.reset(stmt);
+				if (r != SQLITE_OK)
+				{
+					// Note: SQLite returns a handle even when the open fails, and it still has to be closed.
+					std::string error_message{ db ? sqlite3_errmsg(db) : sqlite3_errstr(r) };
+
+					sqlite3_close(db);
+
+					throw std::runtime_error{ "sqlite open: " + error_message + " " + path_name.string() };
+				}
 			}
 
-			RowRange<RowType> ExecuteRows() requires(std::empty(PTuple))
+			~SQLite3Manager()
 			{
-				ResetStmt();
+				statement_cache.clear();
 
-				return RowRange<RowType>(stmt.get());
+				[[maybe_unused]] auto const r{ sqlite3_close(db) };
+
+				assert(r == SQLITE_OK);
 			}
 
-			RowRange<RowType> ExecuteRows(PTuple p_tuple)
+			template <FixedString query_string>
+			auto PrepareStatement() const
 			{
-				ResetStmt();
-				DoBinding(stmt.get(), std::move(p_tuple));
+				return PreparedStatement<query_string>{ db, statement_cache, &profiler, &query_plans };
+			}
 
-				return RowRange<RowType>(stmt.get());
+			StatementCache& Statements() const
+			{
+				return statement_cache;
 			}
 
-			std::optional<decltype(ToConcrete(std::declval<RowType>()))> ExecuteSingleRow(PTuple p_tuple)
+			StatementProfiler& Profiler() const
 			{
-				auto rng{ ExecuteRows(std::move(p_tuple)) };
-				
-				if (auto begin{ std::begin(rng) }; begin != std::end(rng))
-				{
-					return ToConcrete(*begin);
-				}
-				else
-				{
-					return std::nullopt;
-				}
+				return profiler;
 			}
 
-			std::optional<decltype(ToConcrete(std::declval<RowType>()))> ExecuteSingleRow()
-				requires (PTuple::empty())
+			QueryPlanVerifier& QueryPlans() const
 			{
-				auto rng{ ExecuteRows() };
-				
-				if (auto begin{ std::begin(rng) }; begin != std::end(rng))
-				{
-					return ToConcrete(*begin);
-				}
-				else
-				{
-					return std::nullopt;
-				}
+				return query_plans;
 			}
 
-			void Execute(PTuple p_tuple) 
+			Transaction BeginTransaction(TransactionMode mode = TransactionMode::Deferred) const
 			{
-				ResetStmt();
-				DoBinding(stmt.get(), std::move(p_tuple));
-				
-				auto r{ sqlite3_step(stmt.get()) };
+				return Transaction{ db, mode, busy_retry };
+			}
 
-				CheckSqliteReturn(r, SQLITE_DONE);
+			Savepoint BeginSavepoint() const
+			{
+				return Savepoint{ db, busy_retry, &change_feed };
 			}
 
-			void Execute()
-				requires (PTuple::empty())
+			void BusyRetryPolicy(BusyRetry retry)
 			{
-				ResetStmt();
-				
-				auto r{ sqlite3_step(stmt.get()) };
+				busy_retry = retry;
+			}
 
-				CheckSqliteReturn(r, SQLITE_DONE);
+			PragmaSettings Pragmas() const
+			{
+				return ReadPragmas(db);
 			}
 
-		private:
-			UniqueStmt stmt;
+			// Applies every setting it can, then throws naming the ones that failed.
+			void Pragmas(PragmaSettings const& settings) const
+			{
+				if (auto const failed{ WritePragmas(db, settings, busy_retry) }; !std::empty(failed))
+				{
+					throw std::runtime_error{ "sqlite pragma: " + failed };
+				}
+			}
 
-			void ResetStmt()
+			std::int64_t LastInsertRowId() const
 			{
-				auto r{ sqlite3_reset(stmt.get()) };
+				return sqlite3_last_insert_rowid(db);
+			}
 
-				CheckSqliteReturn(r);
-				r = sqlite3_clear_bindings(stmt.get());
-				CheckSqliteReturn(r);
+			// listener is called from DispatchChanges() with the rows of TableName each committed transaction changed.
+			// Note: Watches the table in the main database only, which is also where FetchChangedRows reads it.
+			template <auto TableName>
+			std::size_t SubscribeChanges(ChangeFeed::Listener listener) const
+			{
+				return change_feed.Subscribe(db, "main", std::string{ TableName.ToStringView() }, std::move(listener));
 			}
-		};
 
-		// NAT = NameAndType
-		template <auto NAT, TemplateTemplateParameter<NDataStructure::InternalTaggedTuple::TaggedTuple> T>
-			requires requires { NAT.Name(); }
-		decltype(auto) Field(T&& t)
-		{
-			return NDataStructure::Get<NAT.Name()>(std::forward<T>(t));
-		}
+			void UnsubscribeChanges(std::size_t id) const
+			{
+				change_feed.Unsubscribe(id);
+			}
 
-		template <FixedString fs, TemplateTemplateParameter<NDataStructure::InternalTaggedTuple::TaggedTuple> T>
-		decltype(auto) Field(T&& t)
-		{
-			return NDataStructure::Get<fs>(std::forward<T>(t));
-		}
+			std::size_t DispatchChanges() const
+			{
+				return change_feed.Dispatch();
+			}
 
-		// NAT = NameAndType
-		template <auto NAT, std::convertible_to<typename decltype(NAT)::value_type> T>
-			requires requires { NAT.Name(); }
-		auto Bind(T&& t)
-		{
-			return NDataStructure::tag<NAT.Name()> = std::forward<T>(t);
-		}
+			// Reads the current NATS of the rows inserted or updated in events. Rows deleted since are skipped.
+			template <auto TableName, auto... NATS>
+			auto FetchChangedRows(std::span<ChangeEvent const> events) const
+			{
+				PreparedStatement<
+					"SELECT "_fs
+					+ MakeColumnList(NATS...)
+					+ " FROM main." + TableName + " WHERE rowid = ?/*:changed_rowid:integer*/;"
+				> statement{ db, statement_cache, &profiler, &query_plans };
+				std::vector<typename decltype(statement)::ConcreteRowType> rows;
 
-		template <FixedString fs, typename T>
-		auto Bind(T&& t)
-		{
-			return NDataStructure::tag<fs> = std::forward<T>(t);
-		}
+				rows.reserve(std::size(events));
 
-		using Literals::operator""_fs;
+				for (auto const& event : events)
+				{
+					if (event.kind == ChangeKind::Delete)
+					{
+						continue;
+					}
 
-		class SQLite3Manager final
-		{
-		public:
-			explicit SQLite3Manager(std::filesystem::path const& path_name)
-			{
-				assert(sqlite3_open(path_name.string().c_str(), &db) == SQLITE_OK);
+					if (auto row{ statement.ExecuteSingleRow({ Bind<"changed_rowid"_fs>(event.rowid) }) })
+					{
+						rows.push_back(std::move(*row));
+					}
+				}
+
+				return rows;
 			}
 
-			~SQLite3Manager()
+			// Opens the NAT column of the row of TableName whose rowid, or INTEGER PRIMARY KEY, is rowid.
+			template <auto TableName, auto NAT>
+			BlobStream OpenBlob(std::int64_t rowid, BlobAccess access = BlobAccess::ReadOnly) const
 			{
-				assert(sqlite3_close(db) == SQLITE_OK);
+				return BlobStream{ db, TableName.data, NAT.Name().data, rowid, access };
 			}
 
-			template <FixedString query_string>
-			auto PrepareStatement() const
+			// Reverts to the previous values when the returned scope ends.
+			PragmaScope ApplyPragmas(PragmaSettings const& settings) const
 			{
-				return PreparedStatement<query_string>{ db };
+				return PragmaScope{ db, settings, busy_retry };
 			}
 
 			int Version() const
 			{
 				auto opt{ PreparedStatement<
 					"PRAGMA "_fs + user_version.Column() + ";"
-				>{ db }.ExecuteSingleRow({}) };
+				>{ db, statement_cache, &profiler, &query_plans }.ExecuteSingleRow({}) };
 
 				return opt ? Field<user_version>(*opt) : 0;
 			}
@@ -1447,7 +4058,7 @@ namespace NDatabase
 			{
 				PreparedStatement<
 					"PRAGMA "_fs + user_version.Name() + " = " + IntergralToString<version>() + ";"
-				>{ db }.Execute();
+				>{ db, statement_cache, &profiler, &query_plans }.Execute();
 			}
 
 			template <auto TableName>
@@ -1456,11 +4067,12 @@ namespace NDatabase
 				auto opt{ PreparedStatement<
 					"SELECT count(*) AS "_fs + exist.Column() + " FROM sqlite_master WHERE TYPE = 'table' AND NAME = '"_fs
 					+ TableName + "';"
-				>{ db }.ExecuteSingleRow({}) };
+				>{ db, statement_cache, &profiler, &query_plans }.ExecuteSingleRow({}) };
 
 				return opt ? Field<exist>(*opt) : false;
 			}
 
+			// Also creates the index each NameAndType declares with IndexKind.
 			template <auto TableName, auto... NATS>
 			void Create() const
 			{
@@ -1470,7 +4082,29 @@ namespace NDatabase
 						NATS...
 					)
 					+ ");"
-				>{ db }.Execute();
+				>{ db, statement_cache, &profiler, &query_plans }.Execute();
+
+				([this] {
+					if constexpr (NATS.Indexed() != IndexKind::None)
+					{
+						CreateIndex<TableName, NATS.Indexed(), NATS>();
+					}
+				}(), ...);
+			}
+
+			// Index on NATS in order, named "<table>_<column>_<column>...". Trailing columns that are only read,
+			// not searched, make it a covering index for the queries that read them.
+			template <auto TableName, IndexKind index_kind, auto... NATS>
+				requires (index_kind != IndexKind::None && sizeof...(NATS) != 0)
+			void CreateIndex() const
+			{
+				PreparedStatement<
+					MakeCreateIndexPrefix<index_kind>() + TableName + "_"
+					+ MakeIndexName(NATS...)
+					+ " ON " + TableName + "("
+					+ MakeNameList(NATS...)
+					+ ");"
+				>{ db, statement_cache, &profiler, &query_plans }.Execute();
 			}
 
 			template <auto TableName>
@@ -1478,7 +4112,7 @@ namespace NDatabase
 			{
 				PreparedStatement<
 					"DROP TABLE IF EXISTS "_fs + TableName + ";"
-				>{ db }.Execute();
+				>{ db, statement_cache, &profiler, &query_plans }.Execute();
 			}
 
 			template <auto TableName, auto... NATS>
@@ -1494,7 +4128,7 @@ namespace NDatabase
 						NATS...
 					)
 					+ ");"
-				>{ db };
+				>{ db, statement_cache, &profiler, &query_plans };
 			}
 
 			template <auto TypeName, auto... NATS>
@@ -1506,7 +4140,7 @@ namespace NDatabase
 						NATS...
 					)
 					+ " FROM " + TypeName + ";"
-				> { db };
+				>{ db, statement_cache, &profiler, &query_plans };
 			}
 
 			template <auto TypeName, auto NATS, auto WHERE>
@@ -1518,7 +4152,7 @@ namespace NDatabase
 					+ " FROM " + TypeName 
 					+ " WHERE " + WHERE
 					+ ";"
-				> { db };
+				>{ db, statement_cache, &profiler, &query_plans };
 			}
 
 			template <auto TableName>
@@ -1526,7 +4160,7 @@ namespace NDatabase
 			{
 				return PreparedStatement<
 					"DELETE FROM "_fs + TableName + ";"
-				>{ db };
+				>{ db, statement_cache, &profiler, &query_plans };
 			}
 
 			template <auto TableName, auto WHERE>
@@ -1536,7 +4170,7 @@ namespace NDatabase
 					"DELETE FROM "_fs + TableName
 					+ " WHERE " + WHERE
 					+ ";"
-				>{ db };
+				>{ db, statement_cache, &profiler, &query_plans };
 			}
 
 			template <auto TableName, auto... NATS>
@@ -1548,7 +4182,53 @@ namespace NDatabase
 					+ ") VALUES("
 					+ MakeDeclList(NATS...)
 					+ ");"
-				>{ db };
+				>{ db, statement_cache, &profiler, &query_plans };
+			}
+
+			// Updates NATS of the row whose KeyNAT matches, leaving every other column as it is.
+			template <auto TableName, auto KeyNAT, auto... NATS>
+			auto PreparedUpdate() const
+			{
+				return PreparedStatement<
+					"UPDATE "_fs + TableName + " SET "
+					+ MakeAssignmentList(NATS...)
+					+ " WHERE " + KeyNAT.Name() + " = " + KeyNAT.Decl()
+					+ ";"
+				>{ db, statement_cache, &profiler, &query_plans };
+			}
+
+			// Inserts the row, or updates NATS in place when KeyNAT already exists. Unlike INSERT OR REPLACE,
+			// the existing row is not deleted, so its other columns and its rowid stay and indexes are only touched for NATS.
+			// Note: KeyNAT must be the PRIMARY KEY or carry a UNIQUE index.
+			template <auto TableName, auto KeyNAT, auto... NATS>
+			auto PreparedUpsert() const
+			{
+				return PreparedStatement<
+					"INSERT INTO "_fs + TableName + "("
+					+ MakeNameList(KeyNAT, NATS...)
+					+ ") VALUES("
+					+ MakeDeclList(KeyNAT, NATS...)
+					+ ") ON CONFLICT(" + KeyNAT.Name() + ") DO UPDATE SET "
+					+ MakeExcludedList(NATS...)
+					+ ";"
+				>{ db, statement_cache, &profiler, &query_plans };
+			}
+
+			// Writes only the columns of row set in changed, bit i standing for the i-th of NATS, to the row whose KeyNAT matches.
+			// Returns the number of rows changed. The statement of each distinct set of columns is kept in Statements() like any other
+			// query, so at most its capacity of them stay prepared, and is profiled and plan-checked under its own text.
+			template <auto TableName, auto KeyNAT, auto... NATS, typename Row>
+			int UpdateChanged(Row const& row, std::bitset<sizeof...(NATS)> changed) const
+			{
+				return WriteChanged<false, TableName, KeyNAT, NATS...>(row, changed);
+			}
+
+			// Like UpdateChanged, but inserts row when KeyNAT does not exist yet, with the columns in changed only.
+			// Note: SQLite checks NOT NULL before ON CONFLICT, so a column left out of changed needs a default even when the row exists.
+			template <auto TableName, auto KeyNAT, auto... NATS, typename Row>
+			int UpsertChanged(Row const& row, std::bitset<sizeof...(NATS)> changed) const
+			{
+				return WriteChanged<true, TableName, KeyNAT, NATS...>(row, changed);
 			}
 
 			// Helper Functions
@@ -1570,12 +4250,43 @@ namespace NDatabase
 				return (t.Decl() + ... + (", "_fs + MakeDeclList(ts)));
 			}
 
+			template <typename T, typename... Ts>
+			static constexpr auto MakeAssignmentList(T const& t, Ts const&... ts)
+			{
+				return ((t.Name() + " = " + t.Decl()) + ... + (", "_fs + MakeAssignmentList(ts)));
+			}
+
+			template <typename T, typename... Ts>
+			static constexpr auto MakeExcludedList(T const& t, Ts const&... ts)
+			{
+				return ((t.Name() + " = excluded." + t.Name()) + ... + (", "_fs + MakeExcludedList(ts)));
+			}
+
 			template <typename T, typename... Ts>
 			static constexpr auto MakeTypeDescriptionList(T const& t, Ts const&... ts)
 			{
 				return ((t.Name() + " " + t.TypeDescription()) + ... + (", "_fs + MakeTypeDescriptionList(ts)));
 			}
 
+			template <typename T, typename... Ts>
+			static constexpr auto MakeIndexName(T const& t, Ts const&... ts)
+			{
+				return (t.Name() + ... + ("_"_fs + MakeIndexName(ts)));
+			}
+
+			template <IndexKind index_kind>
+			static constexpr auto MakeCreateIndexPrefix()
+			{
+				if constexpr (index_kind == IndexKind::Unique)
+				{
+					return "CREATE UNIQUE INDEX IF NOT EXISTS "_fs;
+				}
+				else
+				{
+					return "CREATE INDEX IF NOT EXISTS "_fs;
+				}
+			}
+
 			template <typename T>
 			static inline constexpr bool IsStringType_v = std::is_constructible_v<std::string, T>
 				|| std::is_constructible_v<std::wstring, T>
@@ -1628,6 +4339,10 @@ namespace NDatabase
 				{
 					return v;
 				}
+				else if constexpr (is_epoch_time<From>)
+				{
+					return std::chrono::time_point<std::chrono::system_clock, typename From::duration>{ v };
+				}
 				else if constexpr (std::is_same_v<From, std::vector<unsigned char>>)
 				{
 					std::stringstream ss;
@@ -1659,7 +4374,144 @@ namespace NDatabase
 			}
 
 		private:
+			// UPDATE t SET c1 = ?2, c2 = ?3 WHERE key = ?1;
+			// INSERT INTO t(key, c1, c2) VALUES(?1, ?2, ?3) ON CONFLICT(key) DO UPDATE SET c1 = excluded.c1, c2 = excluded.c2;
+			template <bool upsert, typename Query, std::size_t N>
+			static std::string ColumnSetSql(Query const& query, std::bitset<N> changed)
+			{
+				auto const names{ std::apply([](bool, auto const&, auto const&, auto const&... columns) {
+					return std::array<std::string_view, N>{ columns.ToStringView()... };
+				}, query) };
+				auto const table{ std::get<1>(query).ToStringView() };
+				auto const key{ std::get<2>(query).ToStringView() };
+				std::string sql;
+				std::string excluded;
+				auto index{ 2 };
+
+				if constexpr (upsert)
+				{
+					sql.append("INSERT INTO ").append(table).append("(").append(key);
+				}
+				else
+				{
+					sql.append("UPDATE ").append(table).append(" SET ");
+				}
+
+				for (std::size_t i{}; i != std::size(names); ++i)
+				{
+					if (!changed[i])
+					{
+						continue;
+					}
+
+					if constexpr (upsert)
+					{
+						sql.append(", ").append(names[i]);
+						excluded.append(index == 2 ? "" : ", ").append(names[i]).append(" = excluded.").append(names[i]);
+					}
+					else
+					{
+						sql.append(index == 2 ? "" : ", ").append(names[i]).append(" = ?").append(std::to_string(index));
+					}
+
+					++index;
+				}
+
+				if constexpr (upsert)
+				{
+					sql.append(") VALUES(?1");
+
+					for (auto i{ 2 }; i != index; ++i)
+					{
+						sql.append(", ?").append(std::to_string(i));
+					}
+
+					sql.append(") ON CONFLICT(").append(key).append(") DO UPDATE SET ").append(excluded).append(";");
+				}
+				else
+				{
+					sql.append(" WHERE ").append(key).append(" = ?1;");
+				}
+
+				return sql;
+			}
+
+			template <bool upsert, auto TableName, auto KeyNAT, auto... NATS, typename Row>
+			int WriteChanged(Row const& row, std::bitset<sizeof...(NATS)> changed) const
+			{
+				static_assert(sizeof...(NATS) <= 64, "a partial write covers at most 64 columns");
+
+				// Note: Also the cache key. Only identical writes have identical contents, so folding it with another instantiation is harmless.
+				static constexpr std::tuple query{ upsert, TableName, KeyNAT.Name(), NATS.Name()... };
+
+				if (changed.none())
+				{
+					return 0;
+				}
+
+				StatementKey const key{ &query, changed.to_ullong() };
+				auto stmt{ statement_cache.Acquire(key) };
+				std::string sql;
+
+				// Note: The text is only needed to prepare, and to name the statistics the first time they are looked up.
+				if (!stmt || profiler.Enabled())
+				{
+					sql = ColumnSetSql<upsert>(query, changed);
+				}
+
+				auto const statistics{ profiler.Find(key, sql) };
+
+				if (!stmt)
+				{
+					auto const begin{ std::chrono::steady_clock::now() };
+					sqlite3_stmt* prepared;
+
+					CheckSqliteReturn(sqlite3_prepare_v2(db, std::data(sql), static_cast<int>(std::size(sql)), &prepared, nullptr));
+					stmt.reset(prepared);
+
+					if (statistics)
+					{
+						++statistics->prepares;
+						statistics->prepare_time += std::chrono::steady_clock::now() - begin;
+					}
+
+					query_plans.Verify(db, key, sql);
+				}
+				else if (statistics)
+				{
+					++statistics->cache_hits;
+				}
+
+				ExecutionTimer timer{ statistics };
+				auto const bind{ [s = stmt.get()](int index, auto const& value) {
+					CheckSqliteReturn<bool>(SqlType<std::remove_cvref_t<decltype(value)>>::BindImpl(s, index, value, SQLITE_STATIC), true);
+				} };
+				auto index{ 2 };
+				std::size_t i{};
+
+				bind(1, Field<KeyNAT>(row));
+				((changed[i++] ? bind(index++, Field<NATS>(row)) : void()), ...);
+
+				auto const r{ Step(stmt.get(), statistics) };
+
+				if (statistics)
+				{
+					statistics->Collect(stmt.get());
+				}
+
+				// Note: The bindings point into row; Release() clears them before the statement is reused.
+				statement_cache.Release(key, std::move(stmt));
+				CheckSqliteReturn(r, SQLITE_DONE);
+
+				return sqlite3_changes(db);
+			}
+
 			sqlite3* db{ nullptr };
+			mutable StatementCache statement_cache;
+			mutable StatementProfiler profiler;
+			mutable QueryPlanVerifier query_plans;
+			mutable ChangeFeed change_feed;
+			BusyRetry busy_retry;
 
 			static inline constexpr NameAndType<"user_version", int> user_version;
 			static inline constexpr NameAndType<"exist", bool> exist;
@@ -1667,7 +4519,27 @@ namespace NDatabase
 	}
 
 	using Sqlite3::Bind;
+	using Sqlite3::BlobAccess;
+	using Sqlite3::BlobStream;
+	using Sqlite3::BusyRetry;
+	using Sqlite3::ChangeEvent;
+	using Sqlite3::ChangeFeed;
+	using Sqlite3::ChangeKind;
 	using Sqlite3::Field;
+	using Sqlite3::FindPragmaProfile;
+	using Sqlite3::IndexKind;
+	using Sqlite3::JournalMode;
 	using Sqlite3::NameAndType;
+	using Sqlite3::PragmaScope;
+	using Sqlite3::PragmaSettings;
+	namespace PragmaProfiles = Sqlite3::PragmaProfiles;
+	using Sqlite3::QueryPlanPolicy;
+	using Sqlite3::QueryPlanRules;
+	using Sqlite3::Savepoint;
 	using Sqlite3::SQLite3Manager;
+	using Sqlite3::Synchronous;
+	using Sqlite3::TempStore;
+	using Sqlite3::Transaction;
+	using Sqlite3::TransactionMode;
+	using Sqlite3::ZeroBlob;
 }
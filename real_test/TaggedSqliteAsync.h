@@ -0,0 +1,299 @@
+#pragma once
+#include "TaggedSqlite.h"
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// co_await-able query execution. Every statement of an AsyncSQLite3Manager is prepared and stepped on its own
+// worker thread, so the awaiting thread never blocks on SQLite.
+namespace NDatabase
+{
+	namespace Sqlite3
+	{
+		class AsyncSQLite3Manager;
+
+		// Awaiter that runs work on the worker thread of connection and resumes the awaiting coroutine with its result.
+		// Note: Exceptions thrown by work are rethrown from co_await.
+		template <typename T>
+		class AsyncResult final
+		{
+		public:
+			AsyncResult(AsyncSQLite3Manager& connection, std::function<T(SQLite3Manager&)> work)
+				: connection{ &connection }, work{ std::move(work) }
+			{
+				// Nothing
+			}
+
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle);
+
+			T await_resume()
+			{
+				if (error)
+				{
+					std::rethrow_exception(error);
+				}
+
+				if constexpr (!std::is_void_v<T>)
+				{
+					return std::move(*result);
+				}
+			}
+
+		private:
+			using Storage = std::conditional_t<std::is_void_v<T>, bool, T>;
+
+			AsyncSQLite3Manager* connection;
+			std::function<T(SQLite3Manager&)> work;
+			std::optional<Storage> result;
+			std::exception_ptr error;
+		};
+
+		// Reads the rows of one query in SoaVector batches, stepping the statement on the worker thread.
+		//	auto rows{ connection.ExecuteRowsAsync<query>(256, parameters) };
+		//
+		//	while (auto batch{ co_await rows.Next() })
+		//	{
+		//		...
+		//	}
+		// Note: A batch stays valid until the next call of Next(). AsyncRows must not outlive its connection.
+		template <FixedString query_string>
+		class AsyncRows final
+		{
+			using Statement = PreparedStatement<query_string>;
+
+		public:
+			using Batch = NDataStructure::SoaVector<typename Statement::ConcreteRowType>;
+
+			AsyncRows(AsyncSQLite3Manager& connection, std::size_t batch_size, typename Statement::ParameterTuple parameters)
+				: connection{ &connection }, state{ std::make_shared<State>(batch_size, std::move(parameters)) }
+			{
+				// Nothing
+			}
+
+			AsyncRows(AsyncRows&&) noexcept = default;
+
+			// The statement goes back to the statement cache on the worker thread, which owns the cache.
+			~AsyncRows();
+
+			// Resumes with the next batch, or nullptr once every row has been read.
+			AsyncResult<Batch const*> Next()
+			{
+				return { *connection, [state = state.get()](SQLite3Manager& manager) -> Batch const* {
+					if (!state->rows)
+					{
+						state->statement.emplace(manager.PrepareStatement<query_string>());
+						state->rows.emplace(state->statement->ExecuteBatches(state->batch_size, state->parameters));
+					}
+					else
+					{
+						state->rows->Next();
+					}
+
+					if (std::empty(state->rows->batch))
+					{
+						return nullptr;
+					}
+
+					// Note: The batch handed out and the one being filled trade places, so neither reallocates.
+					std::swap(state->current, state->rows->batch);
+
+					return &state->current;
+				} };
+			}
+
+		private:
+			struct State
+			{
+				State(std::size_t batch_size, typename Statement::ParameterTuple parameters)
+					: batch_size{ batch_size }, parameters{ std::move(parameters) }
+				{
+					// Nothing
+				}
+
+				std::size_t batch_size;
+				typename Statement::ParameterTuple parameters;
+				std::optional<Statement> statement;
+				std::optional<BatchRange<Batch>> rows;
+				Batch current;
+			};
+
+			AsyncSQLite3Manager* connection;
+			std::shared_ptr<State> state;
+		};
+
+		class AsyncSQLite3Manager final
+		{
+		public:
+			// Called with each coroutine to resume. An event loop should queue the handle and resume it on its own thread.
+			// Note: Without a resumer, coroutines are resumed on the worker thread.
+			using Resumer = std::function<void(std::coroutine_handle<>)>;
+
+			explicit AsyncSQLite3Manager(std::filesystem::path const& path_name, Resumer resumer = {}, std::size_t statement_cache_capacity = 64)
+				: manager{ path_name, statement_cache_capacity }, resumer{ std::move(resumer) }
+			{
+				worker = std::thread{ [this] {
+					Run();
+				} };
+			}
+
+			AsyncSQLite3Manager(AsyncSQLite3Manager const&) = delete;
+			AsyncSQLite3Manager& operator=(AsyncSQLite3Manager const&) = delete;
+
+			// Jobs already posted are finished before the connection closes.
+			~AsyncSQLite3Manager()
+			{
+				{
+					std::lock_guard lock{ mutex };
+
+					stopping = true;
+				}
+
+				ready.notify_one();
+				worker.join();
+			}
+
+			// Runs work(manager) on the worker thread. Any use of the SQLite3Manager goes through here.
+			template <typename F>
+			auto RunAsync(F work) -> AsyncResult<std::invoke_result_t<F&, SQLite3Manager&>>
+			{
+				return { *this, std::move(work) };
+			}
+
+			template <FixedString query_string>
+			AsyncResult<void> ExecuteAsync(typename PreparedStatement<query_string>::ParameterTuple parameters = {})
+			{
+				return RunAsync([parameters = std::move(parameters)](SQLite3Manager& manager) {
+					manager.PrepareStatement<query_string>().Execute(parameters);
+				});
+			}
+
+			template <FixedString query_string>
+			auto ExecuteSingleRowAsync(typename PreparedStatement<query_string>::ParameterTuple parameters = {})
+			{
+				return RunAsync([parameters = std::move(parameters)](SQLite3Manager& manager) {
+					return manager.PrepareStatement<query_string>().ExecuteSingleRow(parameters);
+				});
+			}
+
+			template <FixedString query_string>
+			AsyncRows<query_string> ExecuteRowsAsync(std::size_t batch_size, typename PreparedStatement<query_string>::ParameterTuple parameters = {})
+			{
+				return { *this, batch_size, std::move(parameters) };
+			}
+
+			void Post(std::function<void(SQLite3Manager&)> job)
+			{
+				{
+					std::lock_guard lock{ mutex };
+
+					jobs.push_back(std::move(job));
+				}
+
+				ready.notify_one();
+			}
+
+			void Resume(std::coroutine_handle<> handle)
+			{
+				if (resumer)
+				{
+					resumer(handle);
+				}
+				else
+				{
+					handle.resume();
+				}
+			}
+
+		private:
+			void Run()
+			{
+				while (true)
+				{
+					std::function<void(SQLite3Manager&)> job;
+
+					{
+						std::unique_lock lock{ mutex };
+
+						ready.wait(lock, [this] {
+							return stopping || !std::empty(jobs);
+						});
+
+						if (std::empty(jobs))
+						{
+							return;
+						}
+
+						job = std::move(jobs.front());
+						jobs.pop_front();
+					}
+
+					job(manager);
+				}
+			}
+
+			SQLite3Manager manager;
+			Resumer resumer;
+			std::mutex mutex;
+			std::condition_variable ready;
+			std::deque<std::function<void(SQLite3Manager&)>> jobs;
+			bool stopping{ false };
+			std::thread worker;
+		};
+
+		template <typename T>
+		void AsyncResult<T>::await_suspend(std::coroutine_handle<> handle)
+		{
+			// Note: The coroutine may be resumed before Post returns, so this must not be touched afterwards.
+			connection->Post([this, handle](SQLite3Manager& manager) {
+				try
+				{
+					if constexpr (std::is_void_v<T>)
+					{
+						work(manager);
+						result.emplace(true);
+					}
+					else
+					{
+						result.emplace(work(manager));
+					}
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+
+				connection->Resume(handle);
+			});
+		}
+
+		template <FixedString query_string>
+		AsyncRows<query_string>::~AsyncRows()
+		{
+			if (state)
+			{
+				connection->Post([state = std::move(state)](SQLite3Manager&) mutable {
+					state.reset();
+				});
+			}
+		}
+	}
+
+	using Sqlite3::AsyncResult;
+	using Sqlite3::AsyncRows;
+	using Sqlite3::AsyncSQLite3Manager;
+}
\ No newline at end of file
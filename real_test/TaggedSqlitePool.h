@@ -0,0 +1,181 @@
+#pragma once
+#include "TaggedSqlite.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Several connections to one database file in WAL mode. Readers run in parallel, each on its own connection
+// with its own statement cache, while writes go through a single writer connection.
+namespace NDatabase
+{
+	namespace Sqlite3
+	{
+		class SQLite3Pool;
+
+		// Exclusive use of one pooled connection. The connection goes back to the pool on destruction.
+		class PooledConnection final
+		{
+		public:
+			PooledConnection(SQLite3Pool& pool, SQLite3Manager& manager, bool writer)
+				: pool{ &pool }, manager{ &manager }, writer{ writer }
+			{
+				// Nothing
+			}
+
+			PooledConnection(PooledConnection&& other) noexcept
+				: pool{ std::exchange(other.pool, nullptr) }, manager{ other.manager }, writer{ other.writer }
+			{
+				// Nothing
+			}
+
+			PooledConnection& operator=(PooledConnection&&) = delete;
+
+			~PooledConnection();
+
+			SQLite3Manager& operator*() const
+			{
+				return *manager;
+			}
+
+			SQLite3Manager* operator->() const
+			{
+				return manager;
+			}
+
+		private:
+			SQLite3Pool* pool;
+			SQLite3Manager* manager;
+			bool writer;
+		};
+
+		//	SQLite3Pool pool{ "account.db" };
+		//
+		//	{
+		//		auto reader{ pool.Reader() };
+		//		auto statement{ reader->PrepareStatement<"SELECT ...">() };
+		//		...
+		//	}	// statement goes before reader, so it never steps a connection another thread holds
+		//
+		//	pool.Writer()->PreparedInsert<...>().Execute(...);
+		// Note: A path is required. ":memory:" databases cannot be shared between connections and cannot use WAL.
+		// Connections are opened in SQLite's serialized mode, since a lease does not stop a statement or a pipelined
+		// producer thread from using the connection on another thread; each call is still best kept within its lease.
+		class SQLite3Pool final
+		{
+		public:
+			explicit SQLite3Pool(std::filesystem::path const& path_name, std::size_t reader_count = std::max(std::thread::hardware_concurrency(), 1u), std::size_t statement_cache_capacity = 64)
+				: writer{ path_name, statement_cache_capacity, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX }
+			{
+				// Note: WAL is a property of the file, so setting it once on the writer covers every connection.
+				auto journal_mode{ writer.PrepareStatement<"PRAGMA journal_mode/*:ansi*/ = WAL;">().ExecuteSingleRow({}) };
+
+				if (!journal_mode || Field<"journal_mode">(*journal_mode) != "wal")
+				{
+					throw std::runtime_error{ "sqlite pool: WAL mode is not available for " + path_name.string() };
+				}
+
+				readers.reserve(reader_count);
+				idle_readers.reserve(reader_count);
+
+				for (std::size_t i{}; i != reader_count; ++i)
+				{
+					readers.push_back(std::make_unique<SQLite3Manager>(path_name, statement_cache_capacity, SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX));
+					idle_readers.push_back(readers.back().get());
+				}
+			}
+
+			SQLite3Pool(SQLite3Pool const&) = delete;
+			SQLite3Pool& operator=(SQLite3Pool const&) = delete;
+
+			// Every PooledConnection must be gone before the pool is destroyed.
+			~SQLite3Pool() = default;
+
+			// Waits until a reader connection is idle.
+			PooledConnection Reader()
+			{
+				std::unique_lock lock{ mutex };
+
+				reader_idle.wait(lock, [this] {
+					return !std::empty(idle_readers);
+				});
+
+				auto manager{ idle_readers.back() };
+
+				idle_readers.pop_back();
+
+				return { *this, *manager, false };
+			}
+
+			// Waits until no other thread holds the writer connection.
+			PooledConnection Writer()
+			{
+				std::unique_lock lock{ mutex };
+
+				writer_idle.wait(lock, [this] {
+					return !writer_busy;
+				});
+
+				writer_busy = true;
+
+				return { *this, writer, true };
+			}
+
+			std::size_t ReaderCount() const
+			{
+				return std::size(readers);
+			}
+
+			void Return(SQLite3Manager& manager, bool is_writer)
+			{
+				{
+					std::lock_guard lock{ mutex };
+
+					if (is_writer)
+					{
+						writer_busy = false;
+					}
+					else
+					{
+						idle_readers.push_back(&manager);
+					}
+				}
+
+				if (is_writer)
+				{
+					writer_idle.notify_one();
+				}
+				else
+				{
+					reader_idle.notify_one();
+				}
+			}
+
+		private:
+			SQLite3Manager writer;
+			std::vector<std::unique_ptr<SQLite3Manager>> readers;
+			std::mutex mutex;
+			std::condition_variable reader_idle;
+			std::condition_variable writer_idle;
+			std::vector<SQLite3Manager*> idle_readers;
+			bool writer_busy{ false };
+		};
+
+		inline PooledConnection::~PooledConnection()
+		{
+			if (pool)
+			{
+				pool->Return(*manager, writer);
+			}
+		}
+	}
+
+	using Sqlite3::PooledConnection;
+	using Sqlite3::SQLite3Pool;
+}
\ No newline at end of file
@@ -0,0 +1,564 @@
+#include <catch.hpp>
+#include "TaggedSqlite.h"
+#include "TaggedSqlitePool.h"
+#include "TaggedSqliteWriteBehind.h"
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace NDatabase;
+using namespace std::string_literals;
+using Literals::operator""_fs;
+
+namespace
+{
+	inline constexpr NameAndType<"id", std::int64_t, "INTEGER NOT NULL PRIMARY KEY"> id;
+	inline constexpr NameAndType<"name", std::string, "TEXT NOT NULL"> name;
+	inline constexpr NameAndType<"grp", int, "INTEGER NOT NULL"> grp;
+	inline constexpr NameAndType<"code", int, "INTEGER NOT NULL", IndexKind::Index> code;
+	inline constexpr NameAndType<"payload", std::optional<std::vector<unsigned char>>, "BLOB"> payload;
+	inline constexpr NameAndType<"account", std::string, "TEXT NOT NULL", IndexKind::Unique> account;
+	inline constexpr NameAndType<"rank", int, "INTEGER NOT NULL DEFAULT 0"> rank;
+	inline constexpr NameAndType<"note", std::string, "TEXT NOT NULL DEFAULT ''"> note;
+
+	// Input-only range that hands out one cached row and overwrites it on ++, as std::ranges::istream_view does.
+	template <typename Row>
+	class CachedRowRange
+	{
+	public:
+		struct Iterator
+		{
+			using value_type = Row;
+			using difference_type = std::ptrdiff_t;
+
+			CachedRowRange* range;
+
+			Row const& operator*() const
+			{
+				return range->current;
+			}
+
+			Iterator& operator++()
+			{
+				range->Next();
+
+				return *this;
+			}
+
+			void operator++(int)
+			{
+				++*this;
+			}
+
+			bool operator==(std::default_sentinel_t) const
+			{
+				return range->done;
+			}
+		};
+
+		explicit CachedRowRange(std::vector<Row> rows)
+			: rows{ std::move(rows) }
+		{
+			// Nothing
+		}
+
+		Iterator begin()
+		{
+			Next();
+
+			return { this };
+		}
+
+		std::default_sentinel_t end() const
+		{
+			return {};
+		}
+
+	private:
+		void Next()
+		{
+			if (next == std::size(rows))
+			{
+				done = true;
+			}
+			else
+			{
+				current = rows[next++];
+			}
+		}
+
+		std::vector<Row> rows;
+		Row current;
+		std::size_t next{};
+		bool done{ false };
+	};
+
+	std::vector<std::string> Names(SQLite3Manager& sql)
+	{
+		std::vector<std::string> names;
+		auto select{ sql.PrepareStatement<"SELECT name/*:ansi*/ FROM t ORDER BY id;">() };
+
+		for (auto& row : select.ExecuteRows())
+		{
+			names.emplace_back(Field<"name">(row));
+		}
+
+		return names;
+	}
+}
+
+TEST_CASE("ExecuteBatchInputRange", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.Create<"t"_fs, id, name>();
+
+	auto insert{ sql.PreparedInsert<"t"_fs, id, name>() };
+	using Row = decltype(insert)::ParameterTuple;
+
+	static_assert(std::ranges::input_range<CachedRowRange<Row>> && !std::ranges::forward_range<CachedRowRange<Row>>);
+
+	CachedRowRange<Row> rows{ {
+		Row{ Bind<id>(1), Bind<name>("first row"s) },
+		Row{ Bind<id>(2), Bind<name>("second row"s) },
+		Row{ Bind<id>(3), Bind<name>("third row"s) }
+	} };
+
+	REQUIRE(insert.ExecuteBatch(rows) == 3);
+	REQUIRE(Names(sql) == std::vector{ "first row"s, "second row"s, "third row"s });
+}
+
+TEST_CASE("ExecutePipelined", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.Create<"t"_fs, id, name>();
+
+	auto insert{ sql.PreparedInsert<"t"_fs, id, name>() };
+	std::vector<decltype(insert)::ParameterTuple> rows;
+
+	for (std::int64_t i{}; i != 1000; ++i)
+	{
+		rows.push_back({ Bind<id>(i), Bind<name>(std::to_string(i)) });
+	}
+
+	insert.ExecuteBatch(rows);
+
+	auto select{ sql.PrepareStatement<"SELECT id/*:integer*/ FROM t WHERE id >= ?/*:first:integer*/ ORDER BY id;">() };
+	std::int64_t next{ 10 };
+
+	for (auto const& batch : select.ExecutePipelined(64, 3, { Bind<"first"_fs>(std::int64_t{ 10 }) }))
+	{
+		REQUIRE(std::size(batch) <= 64);
+
+		for (auto id : NDataStructure::Get<"id">(batch.Vectors()))
+		{
+			REQUIRE(id == next++);
+		}
+	}
+
+	REQUIRE(next == 1000);
+}
+
+TEST_CASE("QueryPlanVerifier", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.QueryPlans().Policy(QueryPlanPolicy::Throw);
+	sql.Create<"plans"_fs, id, grp, code>();
+
+	REQUIRE(sql.ExistTable<"plans"_fs>());
+	REQUIRE_NOTHROW(sql.PrepareStatement<"SELECT id/*:integer*/ FROM plans WHERE code = ?/*:c:int*/;">());
+	REQUIRE_NOTHROW(sql.PrepareStatement<"SELECT grp/*:int*/ FROM plans WHERE id = ?/*:i:integer*/;">());
+	REQUIRE(std::empty(sql.QueryPlans().Issues()));
+	REQUIRE_THROWS_AS(sql.PrepareStatement<"SELECT id/*:integer*/ FROM plans WHERE grp = ?/*:g:int*/;">(), std::runtime_error);
+	REQUIRE(std::size(sql.QueryPlans().Issues()) == 1);
+
+	sql.QueryPlans().clear();
+	sql.QueryPlans().Policy(QueryPlanPolicy::Report, { .temp_b_tree = false });
+
+	REQUIRE_NOTHROW(sql.PrepareStatement<"SELECT id/*:integer*/ FROM plans WHERE grp = ?/*:g:int*/;">());
+	REQUIRE_NOTHROW(sql.PrepareStatement<"SELECT id/*:integer*/ FROM plans ORDER BY grp;">());
+	REQUIRE(std::size(sql.QueryPlans().Issues()) == 2);
+}
+
+TEST_CASE("OpenFailure", "[Sqlite]")
+{
+	REQUIRE_THROWS_AS(SQLite3Manager(std::filesystem::temp_directory_path() / "missing_dir" / "missing.db", 64, SQLITE_OPEN_READONLY), std::runtime_error);
+}
+
+TEST_CASE("TransactionScope", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.Create<"t"_fs, id, name>();
+
+	auto insert{ sql.PreparedInsert<"t"_fs, id, name>() };
+
+	{
+		auto transaction{ sql.BeginTransaction() };
+
+		insert.Execute({ Bind<id>(1), Bind<name>("committed"s) });
+
+		{
+			auto savepoint{ sql.BeginSavepoint() };
+
+			insert.Execute({ Bind<id>(2), Bind<name>("rolled back"s) });
+			REQUIRE(savepoint.Rollback());
+			REQUIRE(!savepoint.Active());
+		}
+
+		REQUIRE_THROWS_AS([&] {
+			auto savepoint{ sql.BeginSavepoint() };
+
+			insert.Execute({ Bind<id>(3), Bind<name>("rolled back"s) });
+
+			throw std::runtime_error{ "leave the scope" };
+		}(), std::runtime_error);
+	}
+
+	REQUIRE_THROWS_AS([&] {
+		auto transaction{ sql.BeginTransaction() };
+
+		insert.Execute({ Bind<id>(4), Bind<name>("rolled back"s) });
+
+		throw std::runtime_error{ "leave the scope" };
+	}(), std::runtime_error);
+
+	REQUIRE(Names(sql) == std::vector{ "committed"s });
+}
+
+TEST_CASE("WriteBehindQueue", "[Sqlite]")
+{
+	auto const path{ std::filesystem::temp_directory_path() / "tagged_sqlite_write_behind.db" };
+
+	std::filesystem::remove(path);
+
+	{
+		SQLite3Manager sql{ path };
+
+		sql.Create<"t"_fs, id, name>();
+	}
+
+	{
+		// Note: Both writes land in one group, which commits once it holds max_writes writes.
+		WriteBehindQueue queue{ path, { .max_writes = 2, .max_delay = std::chrono::seconds{ 10 } } };
+
+		auto failed{ queue.Enqueue([](SQLite3Manager& sql) {
+			sql.PreparedInsert<"t"_fs, id, name>().Execute({ Bind<id>(1), Bind<name>("rolled back"s) });
+
+			throw std::runtime_error{ "failed after a write" };
+		}) };
+		auto committed{ queue.Enqueue([](SQLite3Manager& sql) {
+			sql.PreparedInsert<"t"_fs, id, name>().Execute({ Bind<id>(2), Bind<name>("committed"s) });
+		}) };
+
+		REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+		REQUIRE_NOTHROW(committed.get());
+	}
+
+	{
+		WriteBehindQueue queue{ path, { .max_writes = 0 } };
+
+		REQUIRE_NOTHROW(queue.Flush().get());
+	}
+
+	{
+		SQLite3Manager sql{ path };
+
+		REQUIRE(Names(sql) == std::vector{ "committed"s });
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("BlobStream", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.Create<"blobs"_fs, id, payload>();
+	sql.PrepareStatement<"INSERT INTO blobs(id, payload) VALUES(?/*:id:integer*/, ?/*:size:zeroblob*/);">()
+		.Execute({ Bind<id>(1), Bind<"size"_fs>(ZeroBlob{ 100 }) });
+
+	auto blob{ sql.OpenBlob<"blobs"_fs, payload>(1, BlobAccess::ReadWrite) };
+	std::vector<unsigned char> bytes(10, 'x');
+	std::vector<unsigned char> too_large(101);
+
+	REQUIRE(blob.size() == 100);
+	REQUIRE_NOTHROW(blob.Write(90, bytes));
+	REQUIRE_THROWS_AS(blob.Write(91, bytes), std::out_of_range);
+	REQUIRE_THROWS_AS(blob.Read(std::size_t{ 1 } << 32, bytes), std::out_of_range);
+	REQUIRE_THROWS_AS(blob.Read(0, too_large), std::out_of_range);
+
+	std::ranges::fill(bytes, 0);
+	blob.Read(90, bytes);
+
+	REQUIRE(bytes == std::vector<unsigned char>(10, 'x'));
+
+	std::vector<unsigned char> no_buffer;
+
+	REQUIRE_THROWS_AS(blob.ForEachChunk(no_buffer, [](auto, auto) {}), std::invalid_argument);
+}
+
+TEST_CASE("ChangeFeed", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.Create<"t"_fs, id, name>();
+	sql.PrepareStatement<"CREATE TEMP TABLE t(id INTEGER NOT NULL PRIMARY KEY, name TEXT NOT NULL);">().Execute();
+
+	std::vector<std::string> changed;
+	auto subscription{ sql.SubscribeChanges<"t"_fs>([&](std::span<ChangeEvent const> events) {
+		for (auto const& row : sql.FetchChangedRows<"t"_fs, name>(events))
+		{
+			changed.push_back(Field<name>(row));
+		}
+	}) };
+
+	sql.PrepareStatement<"INSERT INTO main.t(id, name) VALUES(1, 'main');">().Execute();
+	sql.PrepareStatement<"INSERT INTO temp.t(id, name) VALUES(1, 'temp');">().Execute();
+
+	REQUIRE(sql.DispatchChanges() == 1);
+	REQUIRE(changed == std::vector{ "main"s });
+
+	sql.UnsubscribeChanges(subscription);
+}
+
+TEST_CASE("ChangeFeedForeignHook", "[Sqlite]")
+{
+	sqlite3* db{};
+
+	REQUIRE(sqlite3_open(":memory:", &db) == SQLITE_OK);
+
+	int foreign{};
+	ChangeFeed feed;
+
+	sqlite3_commit_hook(db, [](void*) { return 0; }, &foreign);
+
+	REQUIRE_THROWS_AS(feed.Subscribe(db, "main", "t", [](std::span<ChangeEvent const>) {}), std::logic_error);
+	REQUIRE(sqlite3_commit_hook(db, nullptr, nullptr) == nullptr);
+	REQUIRE_NOTHROW(feed.Subscribe(db, "main", "t", [](std::span<ChangeEvent const>) {}));
+	REQUIRE(sqlite3_commit_hook(db, nullptr, nullptr) == &feed);
+
+	sqlite3_close(db);
+}
+
+TEST_CASE("ChangeFeedSavepointRollback", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.Create<"t"_fs, id, name>();
+
+	auto insert{ sql.PreparedInsert<"t"_fs, id, name>() };
+	std::vector<std::int64_t> changed;
+	auto subscription{ sql.SubscribeChanges<"t"_fs>([&](std::span<ChangeEvent const> events) {
+		for (auto const& event : events)
+		{
+			changed.push_back(event.rowid);
+		}
+	}) };
+
+	{
+		auto transaction{ sql.BeginTransaction() };
+
+		insert.Execute({ Bind<id>(1), Bind<name>("committed"s) });
+
+		{
+			auto savepoint{ sql.BeginSavepoint() };
+
+			insert.Execute({ Bind<id>(2), Bind<name>("rolled back"s) });
+			REQUIRE(savepoint.Rollback());
+		}
+
+		insert.Execute({ Bind<id>(3), Bind<name>("committed"s) });
+	}
+
+	{
+		auto savepoint{ sql.BeginSavepoint() };
+
+		insert.Execute({ Bind<id>(4), Bind<name>("rolled back"s) });
+		REQUIRE(savepoint.Rollback());
+	}
+
+	REQUIRE(sql.DispatchChanges() == 2);
+	REQUIRE(changed == std::vector<std::int64_t>{ 1, 3 });
+
+	sql.UnsubscribeChanges(subscription);
+}
+
+TEST_CASE("WriteChanged", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:", 2 };
+
+	sql.Create<"accounts"_fs, account, rank, note>();
+
+	auto insert{ sql.PreparedInsert<"accounts"_fs, account, rank, note>() };
+	using Row = decltype(insert)::ParameterTuple;
+
+	insert.Execute({ Bind<account>("a"s), Bind<rank>(1), Bind<note>("first"s) });
+
+	auto const rowid{ sql.LastInsertRowId() };
+	auto select{ sql.PrepareStatement<"SELECT rowid/*:integer*/, rank/*:int*/, note/*:ansi*/ FROM accounts WHERE account = ?/*:account:ansi*/;">() };
+	auto fetch{ [&](std::string const& key) {
+		return select.ExecuteSingleRow({ Bind<"account"_fs>(key) }).value();
+	} };
+
+	REQUIRE(sql.UpdateChanged<"accounts"_fs, account, rank, note>(Row{ Bind<account>("a"s), Bind<rank>(2), Bind<note>("renamed"s) }, 0b10) == 1);
+
+	auto updated{ fetch("a") };
+
+	REQUIRE(Field<"rowid">(updated) == rowid);
+	REQUIRE(Field<"rank">(updated) == 1);
+	REQUIRE(Field<"note">(updated) == "renamed");
+
+	REQUIRE(sql.UpsertChanged<"accounts"_fs, account, rank, note>(Row{ Bind<account>("a"s), Bind<rank>(3), Bind<note>("ignored"s) }, 0b01) == 1);
+	REQUIRE(sql.UpsertChanged<"accounts"_fs, account, rank, note>(Row{ Bind<account>("b"s), Bind<rank>(4), Bind<note>("ignored"s) }, 0b01) == 1);
+
+	auto upserted{ fetch("a") };
+	auto inserted{ fetch("b") };
+
+	REQUIRE(Field<"rowid">(upserted) == rowid);
+	REQUIRE(Field<"rank">(upserted) == 3);
+	REQUIRE(Field<"note">(upserted) == "renamed");
+	REQUIRE(Field<"rank">(inserted) == 4);
+	REQUIRE(Field<"note">(inserted) == "");
+	REQUIRE(sql.Statements().size() <= 2);
+}
+
+TEST_CASE("SQLite3Pool", "[Sqlite]")
+{
+	auto const path{ std::filesystem::temp_directory_path() / "tagged_sqlite_pool.db" };
+	auto remove{ [&] {
+		for (auto suffix : { "", "-wal", "-shm" })
+		{
+			std::filesystem::remove(path.string() + suffix);
+		}
+	} };
+
+	remove();
+
+	{
+		SQLite3Pool pool{ path, 2 };
+
+		pool.Writer()->Create<"t"_fs, id, name>();
+
+		std::atomic<bool> done{ false };
+		std::atomic<bool> consistent{ true };
+		std::thread reader{ [&] {
+			std::int64_t last_count{};
+
+			while (!done)
+			{
+				auto connection{ pool.Reader() };
+				auto count{ connection->PrepareStatement<"SELECT count(*) AS n/*:integer*/ FROM t;">().ExecuteSingleRow({}) };
+
+				if (!count || Field<"n">(*count) < last_count)
+				{
+					consistent = false;
+				}
+
+				last_count = count ? Field<"n">(*count) : last_count;
+			}
+		} };
+
+		for (std::int64_t i{}; i != 200; ++i)
+		{
+			auto writer{ pool.Writer() };
+
+			writer->PreparedInsert<"t"_fs, id, name>().Execute({ Bind<id>(i), Bind<name>(std::to_string(i)) });
+		}
+
+		done = true;
+		reader.join();
+
+		REQUIRE(consistent);
+		REQUIRE(std::size(Names(*pool.Reader())) == 200);
+	}
+
+	remove();
+}
+
+TEST_CASE("PragmaScope", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.PrepareStatement<"CREATE TEMP TABLE scratch(id INTEGER NOT NULL PRIMARY KEY);">().Execute();
+
+	auto const before{ sql.Pragmas() };
+
+	{
+		auto scope{ sql.ApplyPragmas(PragmaProfiles::bulk_load) };
+		auto const applied{ sql.Pragmas() };
+
+		REQUIRE(applied.synchronous == Synchronous::Off);
+		REQUIRE(applied.cache_size == -256 * 1024);
+		REQUIRE(applied.temp_store == before.temp_store);
+	}
+
+	auto const restored{ sql.Pragmas() };
+
+	REQUIRE(restored.synchronous == before.synchronous);
+	REQUIRE(restored.cache_size == before.cache_size);
+	REQUIRE(restored.mmap_size == before.mmap_size);
+	REQUIRE(sql.ExistTable<"scratch"_fs>() == false);	// ExistTable looks in main only
+	REQUIRE_NOTHROW(sql.PrepareStatement<"INSERT INTO temp.scratch(id) VALUES(1);">().Execute());
+
+	{
+		auto transaction{ sql.BeginTransaction() };
+
+		REQUIRE_THROWS_AS(sql.ApplyPragmas({ .cache_size = 100, .temp_store = TempStore::File }), std::runtime_error);
+		REQUIRE(sql.Pragmas().cache_size == before.cache_size);
+		REQUIRE(sql.Pragmas().temp_store == before.temp_store);
+	}
+}
+
+TEST_CASE("StatementProfiler", "[Sqlite]")
+{
+	SQLite3Manager sql{ ":memory:" };
+
+	sql.Create<"t"_fs, id, name>();
+	sql.Profiler().Enable(true);
+
+	{
+		auto insert{ sql.PreparedInsert<"t"_fs, id, name>() };
+
+		for (std::int64_t i{}; i != 100; ++i)
+		{
+			insert.Execute({ Bind<id>(i), Bind<name>(std::to_string(i)) });
+		}
+	}
+
+	{
+		auto select{ sql.PrepareStatement<"SELECT id/*:integer*/ FROM t ORDER BY id;">() };
+		std::size_t rows{};
+
+		for (auto const& batch : select.ExecutePipelined(16, 2))
+		{
+			rows += std::size(batch);
+		}
+
+		REQUIRE(rows == 100);
+	}
+
+	auto const snapshot{ sql.Profiler().Snapshot() };
+	auto const find{ [&](std::string_view prefix) {
+		auto const it{ std::ranges::find_if(snapshot, [&](auto const* s) { return s->query.starts_with(prefix); }) };
+
+		REQUIRE(it != std::end(snapshot));
+
+		return *it;
+	} };
+	auto const inserts{ find("INSERT") };
+	auto const selects{ find("SELECT") };
+
+	REQUIRE(inserts->prepares == 1);
+	REQUIRE(inserts->executions == 100);
+	REQUIRE(inserts->execute_latency.count == 100);
+	REQUIRE(selects->rows == 100);
+	REQUIRE(selects->step_latency.count == 101);
+	REQUIRE(selects->bytes_read == 800);
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include "TaggedSqlite.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Write-behind queue. Writes from any thread are collected on one writer thread and committed together
+// in a single transaction (group commit), so many small writes share one fsync and never contend for the connection.
+namespace NDatabase
+{
+	namespace Sqlite3
+	{
+		// A group is committed once it holds max_writes writes or max_delay has passed since its first write.
+		// Note: max_writes 0 is treated as 1.
+		struct GroupCommitPolicy
+		{
+			std::size_t max_writes{ 1000 };
+			std::chrono::milliseconds max_delay{ 10 };
+		};
+
+		//	WriteBehindQueue queue{ "account.db" };
+		//
+		//	auto committed{ queue.Enqueue<query>({ Bind<row>(1), ... }) };
+		//	...
+		//	committed.get();	// Returns once the write is committed, or rethrows why it was not
+		class WriteBehindQueue final
+		{
+		public:
+			explicit WriteBehindQueue(std::filesystem::path const& path_name, GroupCommitPolicy policy = {}, std::size_t statement_cache_capacity = 64)
+				: manager{ path_name, statement_cache_capacity }, policy{ policy }
+			{
+				this->policy.max_writes = std::max<std::size_t>(this->policy.max_writes, 1);
+
+				worker = std::thread{ [this] {
+					Run();
+				} };
+			}
+
+			WriteBehindQueue(WriteBehindQueue const&) = delete;
+			WriteBehindQueue& operator=(WriteBehindQueue const&) = delete;
+
+			// Writes already queued are committed before the connection closes.
+			~WriteBehindQueue()
+			{
+				{
+					std::lock_guard lock{ mutex };
+
+					stopping = true;
+				}
+
+				ready.notify_one();
+				worker.join();
+			}
+
+			template <FixedString query_string>
+			std::future<void> Enqueue(typename PreparedStatement<query_string>::ParameterTuple parameters)
+			{
+				return Enqueue([parameters = std::move(parameters)](SQLite3Manager& manager) {
+					manager.PrepareStatement<query_string>().Execute(parameters);
+				});
+			}
+
+			// Runs work(manager) on the writer thread inside the transaction of its group.
+			// Note: An exception from work fails only its own future and rolls back what that work wrote;
+			// the rest of the group is still committed.
+			std::future<void> Enqueue(std::function<void(SQLite3Manager&)> work)
+			{
+				Write write{ std::move(work) };
+				auto committed{ write.committed.get_future() };
+
+				{
+					std::lock_guard lock{ mutex };
+
+					writes.push_back(std::move(write));
+				}
+
+				ready.notify_one();
+
+				return committed;
+			}
+
+			// Becomes ready once every write queued before the call is committed.
+			std::future<void> Flush()
+			{
+				return Enqueue([](SQLite3Manager&) {
+					// Nothing
+				});
+			}
+
+		private:
+			struct Write
+			{
+				std::function<void(SQLite3Manager&)> work;
+				std::promise<void> committed;
+			};
+
+			void Run()
+			{
+				std::vector<Write> group;
+
+				while (true)
+				{
+					{
+						std::unique_lock lock{ mutex };
+
+						ready.wait(lock, [this] {
+							return stopping || !std::empty(writes);
+						});
+
+						if (std::empty(writes))
+						{
+							return;
+						}
+
+						ready.wait_for(lock, policy.max_delay, [this] {
+							return stopping || std::size(writes) >= policy.max_writes;
+						});
+
+						auto const last{ std::next(std::begin(writes), std::min(std::size(writes), policy.max_writes)) };
+
+						std::move(std::begin(writes), last, std::back_inserter(group));
+						writes.erase(std::begin(writes), last);
+					}
+
+					Commit(group);
+					group.clear();
+				}
+			}
+
+			void Commit(std::vector<Write>& group)
+			{
+				std::vector<std::exception_ptr> errors(std::size(group));
+
+				try
+				{
+					auto transaction{ manager.BeginTransaction(TransactionMode::Immediate) };
+
+					for (std::size_t i{}; i != std::size(group); ++i)
+					{
+						try
+						{
+							auto savepoint{ manager.BeginSavepoint() };
+
+							group[i].work(manager);
+							savepoint.Release();
+						}
+						catch (...)
+						{
+							errors[i] = std::current_exception();
+						}
+					}
+
+					transaction.Commit();
+				}
+				catch (...)
+				{
+					// Note: Nothing of the group is durable, so every write reports the failure.
+					auto const error{ std::current_exception() };
+
+					for (auto& e : errors)
+					{
+						if (!e)
+						{
+							e = error;
+						}
+					}
+				}
+
+				for (std::size_t i{}; i != std::size(group); ++i)
+				{
+					if (errors[i])
+					{
+						group[i].committed.set_exception(errors[i]);
+					}
+					else
+					{
+						group[i].committed.set_value();
+					}
+				}
+			}
+
+			SQLite3Manager manager;
+			GroupCommitPolicy policy;
+			std::mutex mutex;
+			std::condition_variable ready;
+			std::deque<Write> writes;
+			bool stopping{ false };
+			std::thread worker;
+		};
+	}
+
+	using Sqlite3::GroupCommitPolicy;
+	using Sqlite3::WriteBehindQueue;
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "TaggedSqlite.h"
+#include "UnitTest.h"
 #include <iostream>
 #include <chrono>
 #include <format>
@@ -21,7 +22,7 @@ class AccountManager final
 public:
     static inline constexpr auto accounts{ "accounts"_fs };
     static inline constexpr NDatabase::NameAndType<"row", std::int64_t, "INTEGER NOT NULL PRIMARY KEY"> row;
-    static inline constexpr NDatabase::NameAndType<"unique_key", std::u8string, "TEXT NOT NULL"> unique_key;
+    static inline constexpr NDatabase::NameAndType<"unique_key", std::u8string, "TEXT NOT NULL", NDatabase::IndexKind::Unique> unique_key;
     static inline constexpr NDatabase::NameAndType<"type", int, "INTEGER NOT NULL"> type;
     static inline constexpr NDatabase::NameAndType<"login_id", std::u8string, "TEXT NOT NULL"> login_id;
     static inline constexpr NDatabase::NameAndType<"name", std::u8string, "TEXT NOT NULL"> name;
@@ -208,6 +209,9 @@ int main()
 {
     setlocale(LC_ALL, "");
 
+    // Unit Test
+    UnitTest();
+
     AccountManager account_manager{ "account.db" };
 
     std::cout << std::format("Current version: {}\n", account_manager.Version());